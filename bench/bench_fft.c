@@ -0,0 +1,277 @@
+/**
+ * @file bench_fft.c
+ * @brief Host benchmark for fft_processor at one FFT_SIZE / FFT_FIXED_POINT
+ *        (/ FFT_SIZE_FIXED)
+ * 
+ * Built once per configuration (see CMakeLists.txt). Each run times
+ * fft_processor_compute_frame() on synthetic ADC input and prints the
+ * host time per frame plus a checksum of the band output, so that both
+ * speed and numerical regressions are visible.
+ * 
+ * A second pass streams the same input hop by hop through the framer, the
+ * multirate decimation chain and every level's FFT, once with a single
+ * level and once with FFT_MULTIRATE_LEVELS_MAX, to show what the extra
+ * bass resolution costs per hop. A third pass runs the constant-Q filter
+ * bank engine at several band counts (its cost is linear in bands).
+ */
+
+#include "audio/fft_processor.h"
+#include "audio/stft_framer.h"
+#include "audio/multirate.h"
+#include "audio/filter_bank.h"
+#include "config.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define NUM_BANDS       16
+#define NUM_BANDS_MAX   32                  // Largest filter bank band count
+#define FRAME_SET       16                  // Distinct input frames per pattern
+#define BENCH_SAMPLES   (4u * 1024 * 1024)  // Samples processed per pattern
+
+typedef enum {
+    INPUT_SILENCE = 0,
+    INPUT_TONE,
+    INPUT_SWEEP,
+    INPUT_NOISE,
+    INPUT_COUNT
+} input_pattern_t;
+
+static const char *_input_names[INPUT_COUNT] = {"silence", "tone", "sweep", "noise"};
+
+static fft_sample_t _frames[FRAME_SET][FFT_SIZE];
+static uint16_t _raw[FRAME_SET * FFT_SIZE];     // Same input as ADC readings
+
+// ============================================================================
+// Input Generation
+// ============================================================================
+
+static uint32_t _lcg = 1;
+
+static uint32_t next_random(void) {
+    _lcg = _lcg * 1664525u + 1013904223u;
+    return _lcg >> 8;
+}
+
+/**
+ * @brief 12-bit ADC reading for sample n of a pattern
+ */
+static uint16_t adc_sample(input_pattern_t pattern, uint32_t n) {
+    float t = (float)n / SAMPLE_RATE_HZ;
+    float v = 0.0f;
+    
+    switch (pattern) {
+        case INPUT_TONE:
+            v = 0.5f * sinf(2.0f * (float)M_PI * 1000.0f * t);
+            break;
+        case INPUT_SWEEP: {
+            // 100 Hz to 10 kHz over the frame set
+            float span = (float)(FRAME_SET * FFT_SIZE) / SAMPLE_RATE_HZ;
+            float f = 100.0f + 9900.0f * t / span;
+            v = 0.5f * sinf(2.0f * (float)M_PI * f * t);
+            break;
+        }
+        case INPUT_NOISE:
+            v = ((float)(next_random() & 0xFFFF) / 65535.0f - 0.5f) * 0.8f;
+            break;
+        default:
+            break;
+    }
+    
+    int32_t raw = 2048 + (int32_t)(v * 2047.0f);
+    return (uint16_t)CLAMP(raw, 0, 4095);
+}
+
+static void build_frames(input_pattern_t pattern) {
+    _lcg = 1;
+    for (uint32_t f = 0; f < FRAME_SET; f++) {
+        for (uint32_t i = 0; i < FFT_SIZE; i++) {
+            uint16_t raw = adc_sample(pattern, f * FFT_SIZE + i);
+            _raw[f * FFT_SIZE + i] = raw;
+            _frames[f][i] = FFT_SAMPLE_FROM_ADC(raw);
+        }
+    }
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// ============================================================================
+// Streaming Pipeline
+// ============================================================================
+
+/**
+ * @brief Push one hop through framer and decimation chain, run ready FFTs
+ */
+static bool stream_hop(const uint16_t *hop, float *bands) {
+    bool frame_ready = stft_framer_push(hop);
+    const fft_sample_t *frame = stft_framer_frame();
+    uint8_t ready = multirate_push(&frame[FFT_SIZE - FFT_HOP_SIZE], FFT_HOP_SIZE);
+    if (!frame_ready) return true;
+    
+    for (uint8_t level = 1; level < multirate_levels(); level++) {
+        if ((ready & (1u << level)) &&
+            !fft_processor_compute_level(level, multirate_frame(level), bands, NUM_BANDS)) {
+            return false;
+        }
+    }
+    return fft_processor_compute_frame(frame, bands, NUM_BANDS);
+}
+
+/**
+ * @brief Time the streaming pipeline with the given number of levels
+ * @param checksum Output: band sum after each hop over one pass of the input
+ * @return Host time per hop in ns (negative on failure)
+ */
+static double run_stream(uint8_t levels, double *checksum) {
+    const uint32_t hops_per_pass = FRAME_SET * FFT_SIZE / FFT_HOP_SIZE;
+    float bands[NUM_BANDS] = {0};
+    
+    fft_processor_set_levels(levels);
+    stft_framer_init();
+    multirate_configure(FFT_SIZE, levels);
+    
+    *checksum = 0.0;
+    for (uint32_t h = 0; h < hops_per_pass; h++) {
+        if (!stream_hop(&_raw[h * FFT_HOP_SIZE], bands)) return -1.0;
+        for (int b = 0; b < NUM_BANDS; b++) *checksum += bands[b];
+    }
+    
+    uint32_t hops = BENCH_SAMPLES / FFT_HOP_SIZE;
+    uint64_t start = now_ns();
+    for (uint32_t h = 0; h < hops; h++) {
+        if (!stream_hop(&_raw[(h % hops_per_pass) * FFT_HOP_SIZE], bands)) return -1.0;
+    }
+    return (double)(now_ns() - start) / hops;
+}
+
+/**
+ * @brief Time the filter bank engine on the same hops
+ * @param checksum Output: band sum after each hop over one pass of the input
+ * @return Host time per hop in ns (negative on failure)
+ */
+static double run_filters(uint8_t num_bands, double *checksum) {
+    const uint32_t hops_per_pass = FRAME_SET * FFT_SIZE / FFT_HOP_SIZE;
+    float bands[NUM_BANDS_MAX];
+    
+    stft_framer_init();
+    if (!filter_bank_configure(SAMPLE_RATE_HZ, num_bands)) return -1.0;
+    
+    *checksum = 0.0;
+    for (uint32_t h = 0; h < hops_per_pass; h++) {
+        stft_framer_push(&_raw[h * FFT_HOP_SIZE]);
+        filter_bank_push(&stft_framer_frame()[FFT_SIZE - FFT_HOP_SIZE], FFT_HOP_SIZE);
+        filter_bank_get_bands(bands, num_bands);
+        for (int b = 0; b < num_bands; b++) *checksum += bands[b];
+    }
+    
+    uint32_t hops = BENCH_SAMPLES / FFT_HOP_SIZE;
+    uint64_t start = now_ns();
+    for (uint32_t h = 0; h < hops; h++) {
+        stft_framer_push(&_raw[(h % hops_per_pass) * FFT_HOP_SIZE]);
+        filter_bank_push(&stft_framer_frame()[FFT_SIZE - FFT_HOP_SIZE], FFT_HOP_SIZE);
+        if (!filter_bank_get_bands(bands, num_bands)) return -1.0;
+    }
+    return (double)(now_ns() - start) / hops;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv) {
+    bool csv = (argc > 1 && strcmp(argv[1], "--csv") == 0);
+    // "q15c": Q15 kernels specialized for the size (FFT_SIZE_FIXED)
+    const char *mode = FFT_FIXED_POINT ? (FFT_SIZE_FIXED ? "q15c" : "q15") : "float";
+    
+    if (!fft_processor_init(SAMPLE_RATE_HZ)) {
+        fprintf(stderr, "fft_processor_init failed\n");
+        return 1;
+    }
+    
+    uint32_t frames = BENCH_SAMPLES / FFT_SIZE;
+    float bands[NUM_BANDS];
+    
+    for (int p = 0; p < INPUT_COUNT; p++) {
+        build_frames((input_pattern_t)p);
+        
+        // Checksum over the frame set only, independent of the run length
+        double checksum = 0.0;
+        for (uint32_t f = 0; f < FRAME_SET; f++) {
+            fft_processor_compute_frame(_frames[f], bands, NUM_BANDS);
+            for (int b = 0; b < NUM_BANDS; b++) checksum += bands[b];
+        }
+        
+        uint64_t start = now_ns();
+        for (uint32_t f = 0; f < frames; f++) {
+            if (!fft_processor_compute_frame(_frames[f % FRAME_SET], bands, NUM_BANDS)) {
+                fprintf(stderr, "fft_processor_compute_frame failed\n");
+                return 1;
+            }
+        }
+        double ns_per_frame = (double)(now_ns() - start) / frames;
+        
+        if (csv) {
+            printf("fft,%s,%d,%s,%.0f,%.4f\n", mode, FFT_SIZE, _input_names[p],
+                   ns_per_frame, checksum);
+        } else {
+            printf("fft %-5s N=%-4d %-8s %10.0f ns/frame %7.2f ns/sample  band sum %9.4f\n",
+                   mode, FFT_SIZE, _input_names[p], ns_per_frame,
+                   ns_per_frame / FFT_SIZE, checksum);
+        }
+    }
+    
+    const uint8_t stream_levels[2] = {1, FFT_MULTIRATE_LEVELS_MAX};
+    for (int p = 0; p < INPUT_COUNT; p++) {
+        build_frames((input_pattern_t)p);
+        
+        for (int l = 0; l < 2; l++) {
+            double checksum;
+            double ns_per_hop = run_stream(stream_levels[l], &checksum);
+            if (ns_per_hop < 0.0) {
+                fprintf(stderr, "streaming pipeline failed\n");
+                return 1;
+            }
+            
+            if (csv) {
+                printf("stream%u,%s,%d,%s,%.0f,%.4f\n", stream_levels[l], mode, FFT_SIZE,
+                       _input_names[p], ns_per_hop, checksum);
+            } else {
+                printf("stream %-5s N=%-4d %-8s %u level(s) %10.0f ns/hop  band sum %9.4f\n",
+                       mode, FFT_SIZE, _input_names[p], stream_levels[l], ns_per_hop, checksum);
+            }
+        }
+    }
+    
+    const uint8_t filter_bands[3] = {8, NUM_BANDS, NUM_BANDS_MAX};
+    for (int p = 0; p < INPUT_COUNT; p++) {
+        build_frames((input_pattern_t)p);
+        
+        for (int b = 0; b < 3; b++) {
+            double checksum;
+            double ns_per_hop = run_filters(filter_bands[b], &checksum);
+            if (ns_per_hop < 0.0) {
+                fprintf(stderr, "filter bank failed\n");
+                return 1;
+            }
+            
+            if (csv) {
+                printf("filters%u,%s,%d,%s,%.0f,%.4f\n", filter_bands[b], mode, FFT_SIZE,
+                       _input_names[p], ns_per_hop, checksum);
+            } else {
+                printf("filters %-5s N=%-4d %-8s %2u bands %10.0f ns/hop  band sum %9.4f\n",
+                       mode, FFT_SIZE, _input_names[p], filter_bands[b], ns_per_hop, checksum);
+            }
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file bench_themes.c
+ * @brief Host benchmark for the themes, strip renderer and display traffic
+ * 
+ * Every theme is driven by every mock_audio pattern for a fixed number of
+ * frames, through band_dynamics at one band frame per display frame. Reported per frame: host render time, SPI bytes, address-window
+ * calls and pixel transfers, and the SPI time that traffic takes at
+ * DISPLAY_SPI_SPEED. Each run starts like a theme switch: the clear or full
+ * repaint plus the first frame (reported separately as the first frame)
+ * and the theme name overlay for its usual two seconds.
+ * 
+ * The bus numbers are deterministic, so they can be checked against a
+ * baseline:
+ *   theme_bench --write-baseline baseline.csv
+ *   theme_bench --baseline baseline.csv    (exit code 1 on regression)
+ */
+
+#include "display/ili9341.h"
+#include "display/theme_manager.h"
+#include "audio/band_dynamics.h"
+#include "utils/mock_audio.h"
+#include "mock_ili9341.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define NUM_BANDS       16
+#define BENCH_FRAMES    300             // 10 s of display at 30 FPS
+#define PATTERN_COUNT   PATTERN_AUTO    // Every pattern except the cycling one
+
+// Allowed growth over the baseline before a run counts as a regression
+#define TOLERANCE_PERCENT   5
+#define TOLERANCE_BYTES     64
+
+typedef struct {
+    double ns_per_frame;
+    double bytes_per_frame;
+    double windows_per_frame;
+    double transfers_per_frame;
+    uint64_t first_frame_bytes;
+} theme_result_t;
+
+static theme_result_t _results[THEME_COUNT][PATTERN_COUNT];
+
+// ============================================================================
+// Measurement
+// ============================================================================
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void run_theme(theme_type_t theme, mock_audio_pattern_t pattern, theme_result_t *result) {
+    float bands[NUM_BANDS];
+    uint16_t levels[NUM_BANDS];
+    uint16_t peaks[NUM_BANDS];
+    
+    // Fresh theme state, as after switching to it
+    mock_audio_init();
+    band_dynamics_init();
+    band_dynamics_configure(1, TARGET_FPS);
+    theme_manager_init();
+    
+    // The switch (screen clear) and the first frame after it
+    mock_ili9341_reset_stats();
+    theme_manager_set_theme(theme);
+    theme_manager_show_name(2000);
+    mock_audio_generate(bands, NUM_BANDS, pattern);
+    band_dynamics_process(bands, NUM_BANDS, levels, peaks);
+    theme_manager_render(levels, peaks, NUM_BANDS);
+    result->first_frame_bytes = mock_ili9341_stats()->spi_bytes;
+    
+    mock_ili9341_reset_stats();
+    uint64_t render_ns = 0;
+    for (uint32_t f = 0; f < BENCH_FRAMES; f++) {
+        host_advance_time_us(FRAME_TIME_US);
+        mock_audio_generate(bands, NUM_BANDS, pattern);
+        band_dynamics_process(bands, NUM_BANDS, levels, peaks);
+        
+        uint64_t start = now_ns();
+        theme_manager_update_overlay();
+        theme_manager_render(levels, peaks, NUM_BANDS);
+        render_ns += now_ns() - start;
+    }
+    
+    const mock_ili9341_stats_t *stats = mock_ili9341_stats();
+    result->ns_per_frame = (double)render_ns / BENCH_FRAMES;
+    result->bytes_per_frame = (double)stats->spi_bytes / BENCH_FRAMES;
+    result->windows_per_frame = (double)stats->window_calls / BENCH_FRAMES;
+    result->transfers_per_frame = (double)stats->transfers / BENCH_FRAMES;
+}
+
+// ============================================================================
+// Baseline
+// ============================================================================
+
+static bool write_baseline(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    
+    fprintf(f, "# theme,pattern,bytes_per_frame,windows_per_frame\n");
+    for (int t = 0; t < THEME_COUNT; t++) {
+        for (int p = 0; p < PATTERN_COUNT; p++) {
+            fprintf(f, "%d,%d,%.1f,%.2f\n", t, p,
+                    _results[t][p].bytes_per_frame, _results[t][p].windows_per_frame);
+        }
+    }
+    
+    fclose(f);
+    printf("Baseline written to %s\n", path);
+    return true;
+}
+
+/**
+ * @return Number of regressions (or -1 if the baseline cannot be read)
+ */
+static int check_baseline(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    
+    int regressions = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        int t, p;
+        double bytes, windows;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%d,%d,%lf,%lf", &t, &p, &bytes, &windows) != 4) continue;
+        if (t < 0 || t >= THEME_COUNT || p < 0 || p >= PATTERN_COUNT) continue;
+        
+        const theme_result_t *r = &_results[t][p];
+        double max_bytes = bytes * (100 + TOLERANCE_PERCENT) / 100.0 + TOLERANCE_BYTES;
+        double max_windows = windows * (100 + TOLERANCE_PERCENT) / 100.0 + 1.0;
+        
+        if (r->bytes_per_frame > max_bytes || r->windows_per_frame > max_windows) {
+            theme_manager_set_theme((theme_type_t)t);
+            printf("REGRESSION %s / %s: %.0f bytes/frame (baseline %.0f), "
+                   "%.1f windows/frame (baseline %.1f)\n",
+                   theme_manager_get_name(), mock_audio_pattern_name((mock_audio_pattern_t)p),
+                   r->bytes_per_frame, bytes, r->windows_per_frame, windows);
+            regressions++;
+        }
+    }
+    
+    fclose(f);
+    return regressions;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv) {
+    const char *baseline = NULL;
+    const char *write_path = NULL;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline = argv[++i];
+        } else if (strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc) {
+            write_path = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--baseline FILE] [--write-baseline FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    
+    ili9341_init();
+    ili9341_set_rotation(DISPLAY_ROTATION);
+    
+    printf("\n%-12s %-10s %10s %10s %8s %8s %9s %11s\n", "theme", "pattern", "ns/frame",
+           "bytes", "windows", "xfers", "SPI us", "first frame");
+    
+    for (int t = 0; t < THEME_COUNT; t++) {
+        for (int p = 0; p < PATTERN_COUNT; p++) {
+            theme_result_t *r = &_results[t][p];
+            run_theme((theme_type_t)t, (mock_audio_pattern_t)p, r);
+            
+            double spi_us = r->bytes_per_frame * 8.0 * 1e6 / DISPLAY_SPI_SPEED;
+            printf("%-12.12s %-10.10s %10.0f %10.0f %8.1f %8.1f %9.0f %11llu\n",
+                   theme_manager_get_name(), mock_audio_pattern_name((mock_audio_pattern_t)p),
+                   r->ns_per_frame, r->bytes_per_frame, r->windows_per_frame,
+                   r->transfers_per_frame, spi_us, (unsigned long long)r->first_frame_bytes);
+        }
+    }
+    
+    if (write_path && !write_baseline(write_path)) return 1;
+    
+    if (baseline) {
+        int regressions = check_baseline(baseline);
+        if (regressions < 0) return 1;
+        printf("%d regression(s) against %s\n", regressions, baseline);
+        return regressions ? 1 : 0;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,15 @@
+/**
+ * @file clocks.h
+ * @brief Host stand-in for hardware/clocks.h
+ */
+
+#ifndef BENCH_HARDWARE_CLOCKS_H
+#define BENCH_HARDWARE_CLOCKS_H
+
+#include <stdint.h>
+
+enum clock_index { clk_gpout0 = 0, clk_ref, clk_sys, clk_peri, clk_usb, clk_adc, clk_rtc };
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+#endif // BENCH_HARDWARE_CLOCKS_H
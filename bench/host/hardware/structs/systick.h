@@ -0,0 +1,23 @@
+/**
+ * @file systick.h
+ * @brief Host stand-in for hardware/structs/systick.h
+ * 
+ * The counter never moves on the host, so on-device profiler scopes read
+ * zero; the benchmarks time themselves with the host clock.
+ */
+
+#ifndef BENCH_HARDWARE_STRUCTS_SYSTICK_H
+#define BENCH_HARDWARE_STRUCTS_SYSTICK_H
+
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t csr;
+    volatile uint32_t rvr;
+    volatile uint32_t cvr;
+    volatile uint32_t calib;
+} systick_hw_t;
+
+extern systick_hw_t *systick_hw;
+
+#endif // BENCH_HARDWARE_STRUCTS_SYSTICK_H
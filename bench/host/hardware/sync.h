@@ -0,0 +1,13 @@
+/**
+ * @file sync.h
+ * @brief Host stand-in for hardware/sync.h (single core)
+ */
+
+#ifndef BENCH_HARDWARE_SYNC_H
+#define BENCH_HARDWARE_SYNC_H
+
+typedef unsigned int uint;
+
+uint get_core_num(void);
+
+#endif // BENCH_HARDWARE_SYNC_H
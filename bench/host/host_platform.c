@@ -0,0 +1,50 @@
+/**
+ * @file host_platform.c
+ * @brief Host implementations of the Pico SDK calls used by the benchmarks
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+static uint64_t _now_us = 0;
+static systick_hw_t _systick;
+systick_hw_t *systick_hw = &_systick;
+
+void host_advance_time_us(uint64_t us) {
+    _now_us += us;
+}
+
+absolute_time_t get_absolute_time(void) {
+    return _now_us;
+}
+
+uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000);
+}
+
+uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return _now_us + (uint64_t)ms * 1000;
+}
+
+bool time_reached(absolute_time_t t) {
+    return _now_us >= t;
+}
+
+uint get_core_num(void) {
+    return 0;
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    (void)clk_index;
+    return 125000000;
+}
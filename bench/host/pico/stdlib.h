@@ -0,0 +1,34 @@
+/**
+ * @file stdlib.h
+ * @brief Host stand-in for the parts of pico/stdlib.h the benchmarks use
+ * 
+ * Time is simulated: it only moves when the benchmark calls
+ * host_advance_time_us(), so runs are reproducible.
+ */
+
+#ifndef BENCH_PICO_STDLIB_H
+#define BENCH_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time(void);
+uint32_t to_ms_since_boot(absolute_time_t t);
+uint64_t to_us_since_boot(absolute_time_t t);
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+bool time_reached(absolute_time_t t);
+
+static inline void tight_loop_contents(void) {}
+
+/**
+ * @brief Move the simulated clock forward
+ */
+void host_advance_time_us(uint64_t us);
+
+#endif // BENCH_PICO_STDLIB_H
@@ -0,0 +1,214 @@
+/**
+ * @file mock_ili9341.c
+ * @brief Host ILI9341 stand-in with SPI byte accounting
+ * 
+ * Mirrors the cost model of src/display/ili9341.c: one byte per command,
+ * 4-byte CASET/PASET bursts only for bounds that changed, 2 bytes per
+ * pixel. Transfers complete immediately.
+ */
+
+#include "display/ili9341.h"
+#include "mock_ili9341.h"
+#include <string.h>
+
+// ============================================================================
+// Private State
+// ============================================================================
+
+static uint16_t _width = ILI9341_TFTWIDTH;
+static uint16_t _height = ILI9341_TFTHEIGHT;
+static uint8_t _rotation = 0;
+static uint16_t _scroll_line = 0;            // Frame-memory line shown first (VSCRSADD)
+
+static bool _window_valid = false;
+static uint16_t _window_x0, _window_x1;
+static uint16_t _window_y0, _window_y1;
+static uint32_t _write_pos = 0;         // Next pixel inside the window
+
+static uint16_t _framebuffer[ILI9341_TFTWIDTH * ILI9341_TFTHEIGHT];
+static mock_ili9341_stats_t _stats;
+
+// ============================================================================
+// Bus Model
+// ============================================================================
+
+static inline void send_command(uint8_t data_bytes) {
+    _stats.commands++;
+    _stats.spi_bytes += 1 + data_bytes;
+}
+
+/**
+ * @brief Store pixels at the write position, wrapping inside the window
+ */
+static void write_pixels(const uint16_t *pixels, uint16_t color, uint32_t count) {
+    uint32_t w = _window_x1 - _window_x0 + 1;
+    uint32_t h = _window_y1 - _window_y0 + 1;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t pos = _write_pos++ % (w * h);
+        uint32_t x = _window_x0 + pos % w;
+        uint32_t y = _window_y0 + pos / w;
+        if (x < _width && y < _height) {
+            _framebuffer[y * _width + x] = pixels ? pixels[i] : color;
+        }
+    }
+    
+    _stats.spi_bytes += 2 * (uint64_t)count;
+    _stats.pixel_bytes += 2 * (uint64_t)count;
+}
+
+// ============================================================================
+// Public API (display/ili9341.h)
+// ============================================================================
+
+bool ili9341_init(void) {
+    memset(_framebuffer, 0, sizeof(_framebuffer));
+    _window_valid = false;
+    ili9341_set_rotation(0);
+    return true;
+}
+
+void ili9341_set_rotation(uint8_t rotation) {
+    _rotation = rotation % 4;
+    _width = (_rotation & 1) ? ILI9341_TFTHEIGHT : ILI9341_TFTWIDTH;
+    _height = (_rotation & 1) ? ILI9341_TFTWIDTH : ILI9341_TFTHEIGHT;
+    send_command(1);    // MADCTL
+    _window_valid = false;
+}
+
+void ili9341_begin_transaction(void) {}
+void ili9341_end_transaction(void) {}
+
+void ili9341_set_addr_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    _stats.window_calls++;
+    
+    if (!_window_valid || x0 != _window_x0 || x1 != _window_x1) {
+        send_command(4);    // CASET
+        _stats.window_updates++;
+        _window_x0 = x0;
+        _window_x1 = x1;
+    }
+    if (!_window_valid || y0 != _window_y0 || y1 != _window_y1) {
+        send_command(4);    // PASET
+        _stats.window_updates++;
+        _window_y0 = y0;
+        _window_y1 = y1;
+    }
+    
+    _window_valid = true;
+    send_command(0);        // RAMWR
+    _write_pos = 0;
+}
+
+void ili9341_begin_write(void) {}
+
+void ili9341_write_pixel(uint16_t color) {
+    write_pixels(NULL, color, 1);
+}
+
+void ili9341_end_write(void) {}
+
+void ili9341_fill_screen(uint16_t color) {
+    ili9341_fill_rect(0, 0, _width, _height, color);
+}
+
+void ili9341_draw_pixel(int16_t x, int16_t y, uint16_t color) {
+    if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height)) return;
+    
+    ili9341_set_addr_window(x, y, x, y);
+    write_pixels(NULL, color, 1);
+}
+
+void ili9341_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if ((x >= _width) || (y >= _height)) return;
+    if ((x + w - 1) >= _width) w = _width - x;
+    if ((y + h - 1) >= _height) h = _height - y;
+    if ((w <= 0) || (h <= 0)) return;
+    
+    ili9341_set_addr_window(x, y, x + w - 1, y + h - 1);
+    write_pixels(NULL, color, (uint32_t)w * h);
+    _stats.transfers++;
+}
+
+void ili9341_draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    ili9341_fill_rect(x, y, w, 1, color);
+    ili9341_fill_rect(x, y + h - 1, w, 1, color);
+    ili9341_fill_rect(x, y, 1, h, color);
+    ili9341_fill_rect(x + w - 1, y, 1, h, color);
+}
+
+void ili9341_blit_async(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels) {
+    if (!pixels || (w <= 0) || (h <= 0)) return;
+    if ((x < 0) || (y < 0) || ((x + w) > _width) || ((y + h) > _height)) return;
+    
+    ili9341_set_addr_window(x, y, x + w - 1, y + h - 1);
+    write_pixels(pixels, 0, (uint32_t)w * h);
+    _stats.transfers++;
+}
+
+void ili9341_blit(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels) {
+    ili9341_blit_async(x, y, w, h, pixels);
+}
+
+bool ili9341_is_busy(void) {
+    return false;
+}
+
+void ili9341_wait(void) {}
+
+void ili9341_set_scroll_area(uint16_t top_fixed, uint16_t bottom_fixed) {
+    if (top_fixed + bottom_fixed > ILI9341_TFTHEIGHT) return;
+    send_command(6);        // VSCRDEF
+}
+
+void ili9341_scroll_to(uint16_t line) {
+    _scroll_line = line;
+    send_command(2);        // VSCRSADD
+}
+
+void ili9341_scroll_reset(void) {
+    ili9341_set_scroll_area(0, 0);
+    ili9341_scroll_to(0);
+}
+
+bool ili9341_scroll_is_horizontal(void) {
+    return (_rotation & 1) != 0;
+}
+
+uint16_t ili9341_scroll_line_coord(uint16_t line) {
+    return (_rotation >= ILI9341_ROTATION_180) ? (ILI9341_TFTHEIGHT - 1 - line) : line;
+}
+
+uint16_t ili9341_scroll_screen_coord(uint16_t coord) {
+    uint16_t line = (ili9341_scroll_line_coord(coord) + _scroll_line) % ILI9341_TFTHEIGHT;
+    return ili9341_scroll_line_coord(line);
+}
+
+void ili9341_test_pattern(void) {
+    ili9341_fill_screen(ILI9341_BLACK);
+}
+
+uint16_t ili9341_width(void) {
+    return _width;
+}
+
+uint16_t ili9341_height(void) {
+    return _height;
+}
+
+// ============================================================================
+// Accounting
+// ============================================================================
+
+const mock_ili9341_stats_t *mock_ili9341_stats(void) {
+    return &_stats;
+}
+
+void mock_ili9341_reset_stats(void) {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+uint16_t mock_ili9341_pixel(int16_t x, int16_t y) {
+    if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height)) return 0;
+    return _framebuffer[y * _width + x];
+}
@@ -0,0 +1,40 @@
+/**
+ * @file mock_ili9341.h
+ * @brief Bus accounting for the host ILI9341 stand-in
+ * 
+ * mock_ili9341.c implements display/ili9341.h without hardware. Every call
+ * is charged the SPI bytes the real driver would send (commands, CASET /
+ * PASET bursts skipped by the window cache, 2 bytes per pixel), and pixels
+ * land in a frame buffer so rendering can be inspected.
+ */
+
+#ifndef MOCK_ILI9341_H
+#define MOCK_ILI9341_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint64_t spi_bytes;         // Everything clocked out on MOSI
+    uint64_t pixel_bytes;       // Of which pixel data
+    uint32_t window_calls;      // ili9341_set_addr_window() calls
+    uint32_t window_updates;    // CASET/PASET actually sent
+    uint32_t transfers;         // Pixel DMA transfers (fills and blits)
+    uint32_t commands;          // Command bytes (DC low)
+} mock_ili9341_stats_t;
+
+/**
+ * @brief Counters since the last reset
+ */
+const mock_ili9341_stats_t *mock_ili9341_stats(void);
+
+/**
+ * @brief Zero the counters
+ */
+void mock_ili9341_reset_stats(void);
+
+/**
+ * @brief Frame buffer pixel in panel memory order of the current rotation
+ */
+uint16_t mock_ili9341_pixel(int16_t x, int16_t y);
+
+#endif // MOCK_ILI9341_H
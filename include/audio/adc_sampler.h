@@ -3,7 +3,9 @@
  * @brief ADC audio sampling for spectrum analyzer
  * 
  * Captures audio samples from ADC at specified sample rate.
- * Uses free-running ADC with timer-based sampling for consistent timing.
+ * Conversions are started by a PIO sample clock (ADC_PIO_PACING) or by
+ * the ADC's own clock divider, and DMA streams blocks of
+ * ADC_DMA_BLOCK_SIZE samples into a ring buffer without CPU involvement.
  */
 
 #ifndef ADC_SAMPLER_H
@@ -30,6 +32,18 @@ void adc_sampler_start(void);
  */
 void adc_sampler_stop(void);
 
+/**
+ * @brief Change the sample rate
+ * 
+ * Restarts capture if it was running. The ring is emptied and the read
+ * position realigned, so a new acquire block size may be used afterwards.
+ * Fails while a block is acquired.
+ * 
+ * @param sample_rate_hz New sample rate in Hz
+ * @return true if successful (false keeps the current rate)
+ */
+bool adc_sampler_set_rate(uint32_t sample_rate_hz);
+
 /**
  * @brief Check if samples are available
  * @return Number of samples available
@@ -40,13 +54,44 @@ uint32_t adc_sampler_available(void);
  * @brief Read samples from buffer
  * @param buffer Output buffer for samples
  * @param count Number of samples to read
- * @return Number of samples actually read
+ * @return Number of samples actually read (0 while a block is acquired)
  */
 uint32_t adc_sampler_read(uint16_t *buffer, uint32_t count);
 
+/**
+ * @brief Acquire a direct view of the next block of samples in the ring
+ * 
+ * Zero-copy alternative to adc_sampler_read(): the returned pointer refers
+ * to ring memory, which the DMA will not overwrite until the block is
+ * released. Only one block may be held at a time.
+ * 
+ * @param count Block size in samples (power of 2, at most half the ring).
+ *              The read position must stay aligned to it, so do not mix with
+ *              adc_sampler_read() calls of other sizes.
+ * @return Pointer to count contiguous samples, or NULL if not yet available
+ */
+const uint16_t *adc_sampler_acquire_block(uint32_t count);
+
+/**
+ * @brief Release the block returned by adc_sampler_acquire_block()
+ * 
+ * The caller must not touch the block pointer afterwards.
+ */
+void adc_sampler_release_block(void);
+
+/**
+ * @brief Get number of samples dropped because the ring buffer was full
+ * @return Total dropped samples since init (multiple of ADC_DMA_BLOCK_SIZE)
+ */
+uint32_t adc_sampler_get_overruns(void);
+
 /**
  * @brief Get current sample rate
- * @return Sample rate in Hz
+ * 
+ * With ADC_PIO_PACING the period is rounded to whole system clock cycles,
+ * so the true rate differs from the requested one by under 0.02%.
+ * 
+ * @return Sample rate in Hz (as requested)
  */
 uint32_t adc_sampler_get_rate(void);
 
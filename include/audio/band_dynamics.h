@@ -0,0 +1,70 @@
+/**
+ * @file band_dynamics.h
+ * @brief Band dynamics: smoothing, peak hold and automatic gain control
+ * 
+ * Post-processing of every band frame on the audio core, after band
+ * extraction and before it is published to the display core. Produces the
+ * levels the themes draw, so every theme shows the same smoothing and
+ * peaks and no theme keeps per-band state of its own.
+ * 
+ * - Smoothing: first-order follower, SMOOTHING_FACTOR for rises and
+ *   SMOOTHING_RELEASE for falls
+ * - Peak hold: the highest smoothed level, held for PEAK_HOLD_MS, then
+ *   decayed by PEAK_DECAY_RATE
+ * - AGC (AUTO_GAIN_ENABLED): brings the loudest band towards
+ *   AGC_TARGET_LEVEL, at most AGC_MAX_GAIN; gain drops at once on loud
+ *   input and recovers with time constant AGC_RELEASE_MS
+ * 
+ * The factors are per display frame (FRAME_TIME_US) and are converted to
+ * the band frame interval whenever the hop or sample rate changes, so the
+ * response in time does not depend on the FFT size or sample rate. The
+ * per-frame work is integer only.
+ * 
+ * Levels are Q8.8 palette levels: 0 to 255.996 as 0 to 65535, the integer
+ * part indexing a PALETTE_SIZE palette.
+ */
+
+#ifndef BAND_DYNAMICS_H
+#define BAND_DYNAMICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Clear all levels and set up for FFT_HOP_SIZE at SAMPLE_RATE_HZ
+ */
+void band_dynamics_init(void);
+
+/**
+ * @brief Convert the time constants for a new band frame interval
+ * 
+ * Levels and peaks carry over, so a settings change does not flash the
+ * display.
+ * 
+ * @param hop_size Samples between band frames
+ * @param sample_rate_hz Sample rate in Hz
+ * @return true if successful (false keeps the current interval)
+ */
+bool band_dynamics_configure(uint32_t hop_size, uint32_t sample_rate_hz);
+
+/**
+ * @brief Run one band frame through AGC, smoothing and peak hold
+ * @param bands Band amplitudes from the band engine (0.0 to 1.0)
+ * @param num_bands Number of bands (1 to BAND_COUNT_MAX)
+ * @param levels Output: smoothed levels (Q8.8 palette levels)
+ * @param peaks Output: peak-hold levels (Q8.8 palette levels)
+ */
+void band_dynamics_process(const float *bands, uint8_t num_bands,
+                           uint16_t *levels, uint16_t *peaks);
+
+/**
+ * @brief Get the current AGC gain
+ * @return Gain in Q8.8 (256 = 1x; always 256 without AUTO_GAIN_ENABLED)
+ */
+uint32_t band_dynamics_gain(void);
+
+#endif // BAND_DYNAMICS_H
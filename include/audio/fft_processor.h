@@ -11,28 +11,136 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "config.h"  // FFT_SIZE, FFT_SIZE_MIN/MAX, FFT_FIXED_POINT
 
-// FFT configuration
-#define FFT_SIZE 64  // Must match config.h
+/**
+ * @brief Normalized time-domain sample fed to the FFT
+ * 
+ * Q15 (-32768 to 32767 = -1.0 to 1.0) with FFT_FIXED_POINT, float otherwise.
+ */
+#if FFT_FIXED_POINT
+typedef int16_t fft_sample_t;
+#define FFT_SAMPLE_FROM_ADC(raw) ((fft_sample_t)(((int32_t)(raw) - 2048) * 16))
+#else
+typedef float fft_sample_t;
+#define FFT_SAMPLE_FROM_ADC(raw) (((float)(raw) - 2048.0f) / 2048.0f)
+#endif
+
+/**
+ * @brief Transform size that band levels are normalized to
+ * 
+ * A tone's FFT magnitude grows with N; levels are scaled to what an
+ * N = FFT_LEVEL_REFERENCE_SIZE transform gives, so run-time size changes
+ * only change the resolution.
+ */
+#define FFT_LEVEL_REFERENCE_SIZE FFT_SIZE
 
 /**
- * @brief Initialize FFT processor
+ * @brief Initialize FFT processor with the boot FFT size (FFT_SIZE)
  * @param sample_rate_hz Sample rate in Hz
  * @return true if successful
  */
 bool fft_processor_init(uint32_t sample_rate_hz);
 
+/**
+ * @brief Switch FFT size and/or sample rate
+ * 
+ * Re-derives the window, twiddles and band plan in the preallocated
+ * arena; nothing is allocated from the heap. Must not run concurrently
+ * with the compute functions.
+ * 
+ * @param fft_size Power of 2 from FFT_SIZE_MIN to FFT_SIZE_MAX
+ * @param sample_rate_hz Sample rate in Hz
+ * @return true if successful (false leaves the processor unconfigured)
+ */
+bool fft_processor_configure(uint32_t fft_size, uint32_t sample_rate_hz);
+
+/**
+ * @brief Set the number of multirate analysis levels
+ * 
+ * Level L analyses the input decimated to sample_rate / 2^L (same FFT
+ * size, see audio/multirate.h). Each band is assigned to the lowest rate
+ * that covers it, so low bands get 2^L times finer bins.
+ * 
+ * @param levels 1 (full rate only) to FFT_MULTIRATE_LEVELS_MAX
+ * @return true if successful
+ */
+bool fft_processor_set_levels(uint8_t levels);
+
+/**
+ * @brief Get the number of multirate analysis levels
+ */
+uint8_t fft_processor_get_levels(void);
+
+/**
+ * @brief Get the active FFT size (samples per frame)
+ */
+uint32_t fft_processor_get_size(void);
+
+/**
+ * @brief Get the sample rate the band plan was derived for
+ */
+uint32_t fft_processor_get_sample_rate(void);
+
 /**
  * @brief Process audio samples and extract frequency bands
- * @param samples Input audio samples (FFT_SIZE samples)
+ * @param samples Input audio samples (fft_processor_get_size() samples)
  * @param bands Output frequency band amplitudes (0.0 to 1.0)
- * @param num_bands Number of frequency bands to extract
+ * @param num_bands Number of frequency bands to extract (1 to BAND_COUNT_MAX)
  * @return true if successful
  */
 bool fft_processor_compute(const uint16_t *samples, float *bands, uint8_t num_bands);
 
+/**
+ * @brief Process an already normalized frame and extract frequency bands
+ * 
+ * Same as fft_processor_compute_level() at level 0 (full rate).
+ * 
+ * @param frame fft_processor_get_size() normalized samples (see stft_framer)
+ * @param bands Output frequency band amplitudes (0.0 to 1.0)
+ * @param num_bands Number of frequency bands to extract (1 to BAND_COUNT_MAX)
+ * @return true if successful
+ */
+bool fft_processor_compute_frame(const fft_sample_t *frame, float *bands, uint8_t num_bands);
+
+/**
+ * @brief Process a frame of one multirate level
+ * 
+ * Measures only the bands owned by this level; the other bands are
+ * written with their last measured value, so bands always holds a
+ * complete, merged result.
+ * 
+ * @param level 0 (full rate) to fft_processor_get_levels() - 1
+ * @param frame fft_processor_get_size() normalized samples at that level's rate
+ * @param bands Output frequency band amplitudes (0.0 to 1.0)
+ * @param num_bands Number of frequency bands (1 to BAND_COUNT_MAX)
+ * @return true if successful
+ */
+bool fft_processor_compute_level(uint8_t level, const fft_sample_t *frame,
+                                 float *bands, uint8_t num_bands);
+
+/**
+ * @brief Export the magnitude spectrum of the last FFT
+ * 
+ * Bins 0 .. N/2-1 as linear levels with FFT_DISPLAY_GAIN applied (on the
+ * FFT_LEVEL_REFERENCE_SIZE reference, like the bands), quantized
+ * to Q16 and saturated at 0xFFFF (~1.0). After a multirate update the
+ * full-rate FFT runs last, so these are full-rate bins (spacing
+ * sample rate / N).
+ * 
+ * @param bins Output buffer
+ * @param max_bins Capacity of bins
+ * @return Number of bins written (0 before the first FFT)
+ */
+uint32_t fft_processor_get_magnitudes(uint16_t *bins, uint32_t max_bins);
+
 /**
  * @brief Get frequency range for a specific band
+ * 
+ * Uses the same band plan as the compute functions, so the range is the
+ * span of FFT bins actually averaged into the band. Requires
+ * fft_processor_init(); yields 0 Hz for an invalid band.
+ * 
  * @param band_index Band index (0 to num_bands-1)
  * @param num_bands Total number of bands
  * @param freq_min Output: minimum frequency in Hz
@@ -41,5 +149,31 @@ bool fft_processor_compute(const uint16_t *samples, float *bands, uint8_t num_ba
 void fft_processor_get_band_range(uint8_t band_index, uint8_t num_bands, 
                                    float *freq_min, float *freq_max);
 
+/**
+ * @brief Get the nominal (log-spaced) edges of a band
+ * 
+ * FREQ_MIN_HZ to FREQ_MAX_HZ (capped at Nyquist) split into num_bands
+ * equal ratios. Every band engine is built from these edges; the FFT
+ * then rounds them to its bins (see fft_processor_get_band_range()).
+ * 
+ * @param band_index Band index (0 to num_bands-1)
+ * @param num_bands Total number of bands
+ * @param freq_min Output: lower edge in Hz (0 for an invalid band)
+ * @param freq_max Output: upper edge in Hz (0 for an invalid band)
+ */
+void fft_processor_get_band_edges(uint8_t band_index, uint8_t num_bands,
+                                  float *freq_min, float *freq_max);
+
+/**
+ * @brief Map a linear band level to the display scale
+ * 
+ * Applies the same log compression as the FFT bands, so other band
+ * engines produce interchangeable bands[] values.
+ * 
+ * @param linear Linear level, FFT_DISPLAY_GAIN applied (1.0 = full scale)
+ * @return Display level (0.0 to 1.0)
+ */
+float fft_processor_display_level(float linear);
+
 #endif // FFT_PROCESSOR_H
 
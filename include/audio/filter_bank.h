@@ -0,0 +1,61 @@
+/**
+ * @file filter_bank.h
+ * @brief Constant-Q filter bank band engine
+ * 
+ * Alternative to the FFT for small band counts: one single-bin DFT per
+ * band, centred on the band's log-spaced edges and with a block length
+ * matched to the band's width (long for bass, short for treble). Samples
+ * are consumed incrementally as hops arrive, so cost is linear in the
+ * band count and independent of the FFT size. Output uses the same
+ * display scale as fft_processor, so themes cannot tell the engines apart.
+ */
+
+#ifndef FILTER_BANK_H
+#define FILTER_BANK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio/fft_processor.h"  // fft_sample_t
+
+/**
+ * @brief Build the filters for a band layout and clear their state
+ * 
+ * Band edges come from fft_processor_get_band_edges(), so the FFT
+ * processor must be configured for the same sample rate first.
+ * 
+ * @param sample_rate_hz Sample rate in Hz
+ * @param num_bands Number of bands (1 to BAND_COUNT_MAX)
+ * @return true if successful
+ */
+bool filter_bank_configure(uint32_t sample_rate_hz, uint8_t num_bands);
+
+/**
+ * @brief Run every filter over a block of samples
+ * 
+ * A band's level is refreshed each time its block completes.
+ * 
+ * @param samples Normalized samples (e.g. the newest hop of stft_framer)
+ * @param count Number of samples
+ */
+void filter_bank_push(const fft_sample_t *samples, uint32_t count);
+
+/**
+ * @brief Get the latest level of every band
+ * @param bands Output frequency band amplitudes (0.0 to 1.0)
+ * @param num_bands Must match filter_bank_configure()
+ * @return true if successful
+ */
+bool filter_bank_get_bands(float *bands, uint8_t num_bands);
+
+/**
+ * @brief Get the frequency range a band responds to
+ * 
+ * Centre frequency plus/minus the half-power width of its window.
+ * 
+ * @param band_index Band index (0 to num_bands-1)
+ * @param freq_min Output: minimum frequency in Hz (0 for an invalid band)
+ * @param freq_max Output: maximum frequency in Hz (0 for an invalid band)
+ */
+void filter_bank_get_band_range(uint8_t band_index, float *freq_min, float *freq_max);
+
+#endif // FILTER_BANK_H
@@ -0,0 +1,54 @@
+/**
+ * @file multirate.h
+ * @brief Half-band decimation chain for multi-resolution analysis
+ * 
+ * Level 0 is the full-rate stft_framer. Each further level halves the
+ * sample rate of the one above with a half-band low-pass and keeps its
+ * own sliding frame of the same size, so an FFT at level L has 2^L times
+ * finer bins over the bottom 1/2^L of the spectrum, for 1/2^L of the
+ * full-rate FFT cost.
+ */
+
+#ifndef MULTIRATE_H
+#define MULTIRATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio/fft_processor.h"  // fft_sample_t
+
+/**
+ * @brief Set frame size and number of levels, clearing all history
+ * @param frame_size Samples per frame at every level (as stft_framer)
+ * @param levels 1 to FFT_MULTIRATE_LEVELS_MAX (1 = no decimation)
+ * @return true if successful (false keeps the current setup)
+ */
+bool multirate_configure(uint32_t frame_size, uint8_t levels);
+
+/**
+ * @brief Feed one hop of full-rate samples down the decimation chain
+ * @param samples Newest normalized samples (e.g. the last hop of the
+ *                stft_framer frame)
+ * @param count Full-rate hop size
+ * @return Bit mask of the levels (bit L for level L >= 1) that completed a
+ *         new frame with this hop
+ */
+uint8_t multirate_push(const fft_sample_t *samples, uint32_t count);
+
+/**
+ * @brief Get the current frame of a decimated level
+ * 
+ * Valid right after multirate_push() reported the level ready, until the
+ * next push.
+ * 
+ * @param level 1 to multirate_levels() - 1
+ * @return frame_size contiguous normalized samples, oldest first (NULL if
+ *         the level does not exist)
+ */
+const fft_sample_t *multirate_frame(uint8_t level);
+
+/**
+ * @brief Get the number of active levels (including full rate)
+ */
+uint8_t multirate_levels(void);
+
+#endif // MULTIRATE_H
@@ -0,0 +1,151 @@
+/**
+ * @file sample_source.h
+ * @brief Sample source for the audio core: live ADC, capture to flash, replay
+ * 
+ * Hands hops of raw ADC samples to the framer, from one of:
+ * 
+ * - Live: the ADC ring (adc_sampler.h), zero-copy
+ * - Record: the same, and every block is also written to a region reserved
+ *   at the end of the on-board flash (CAPTURE_FLASH_BYTES)
+ * - Replay: the recorded blocks instead of the ADC, paced by the ADC
+ *   sample clock at the recorded rate (real time) or as fast as the
+ *   pipeline takes them (max speed, a throughput benchmark on identical
+ *   input every run)
+ * 
+ * Recording first erases the whole region, one 4 KB sector per service
+ * run, which takes ~12 s for 1 MB. Each sector erase stalls both cores
+ * (~45 ms typical, up to 400 ms), so the display stutters and the live
+ * input may drop samples meanwhile. Blocks are then staged in RAM and
+ * programmed one flash page per service run, so while recording neither
+ * core stalls for longer than a page program. Core 1 is parked in RAM during
+ * every flash operation and core 0 keeps only the ADC DMA interrupt
+ * enabled, so capture continues and no recorded sample is lost. The
+ * header is written last; a recording cut short by a reset leaves no
+ * capture.
+ * 
+ * Capture format, at PICO_FLASH_SIZE_BYTES - CAPTURE_FLASH_BYTES (read it
+ * back with e.g. picotool save -r): a capture_header_t in the first
+ * sector, then num_samples raw 12-bit ADC codes as uint16 (little-endian)
+ * from the second sector on.
+ * 
+ * Only the audio core acquires blocks and services the flash; requests
+ * may come from either core and are applied between hops.
+ */
+
+#ifndef SAMPLE_SOURCE_H
+#define SAMPLE_SOURCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef enum {
+    SOURCE_LIVE = 0,            // ADC
+    SOURCE_RECORD,              // ADC, also written to flash
+    SOURCE_REPLAY,              // Flash capture, in real time
+    SOURCE_REPLAY_FAST          // Flash capture, as fast as it is processed
+} sample_source_mode_t;
+
+#define CAPTURE_MAGIC   0x50414353u     // "SCAP"
+#define CAPTURE_VERSION 1
+
+typedef struct {
+    uint32_t magic;             // CAPTURE_MAGIC
+    uint32_t version;           // CAPTURE_VERSION
+    uint32_t sample_rate_hz;    // Rate the samples were taken at
+    uint32_t num_samples;       // Samples following the header sector
+    uint32_t adc_channel;       // ADC input they came from
+} capture_header_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Set up the live source and check the capture region
+ * 
+ * Call once, after adc_sampler_init(). Without a usable region (firmware
+ * too large for CAPTURE_FLASH_BYTES) only live input is available.
+ * 
+ * @param adc_channel ADC channel being sampled (stored with captures)
+ * @return true if capture and replay are available
+ */
+bool sample_source_init(uint8_t adc_channel);
+
+/**
+ * @brief Ask for a source (applied by the audio core between hops)
+ * 
+ * Replay starts from the beginning of the capture and is paced by the
+ * ADC, so request the capture's sample rate first. A recording that is
+ * still being written out finishes in the background.
+ * 
+ * @param mode Source to switch to
+ * @return false if refused: no capture to replay, no capture region, or
+ *         a recording still being written to flash
+ */
+bool sample_source_request(sample_source_mode_t mode);
+
+/**
+ * @brief Get the source last requested
+ */
+sample_source_mode_t sample_source_get_mode(void);
+
+/**
+ * @brief Get the capture stored in flash
+ * @param sample_rate_hz Output: recorded sample rate (may be NULL)
+ * @param num_samples Output: recorded samples (may be NULL)
+ * @return true if there is a complete capture
+ */
+bool sample_source_get_capture(uint32_t *sample_rate_hz, uint32_t *num_samples);
+
+/**
+ * @brief Apply a requested source (audio core, between hops, no block held)
+ * @return true if replay started or ended: the pipeline should restart
+ *         from clean state so replays start from the same input
+ */
+bool sample_source_update(void);
+
+/**
+ * @brief Check if samples are available
+ * @return Samples that can be acquired now
+ */
+uint32_t sample_source_available(void);
+
+/**
+ * @brief Acquire the next block of samples (see adc_sampler_acquire_block())
+ * 
+ * Returns NULL while a different source is requested, and at the end of
+ * every max-speed replay pass (after printing its throughput), so the
+ * caller gets to apply settings; the next call starts the next pass.
+ * 
+ * @param count Block size in samples (power of 2, at most one hop at
+ *              FFT_SIZE_MAX)
+ * @return Pointer to count samples, or NULL if not yet available
+ */
+const uint16_t *sample_source_acquire_block(uint32_t count);
+
+/**
+ * @brief Release the block returned by sample_source_acquire_block()
+ */
+void sample_source_release_block(void);
+
+/**
+ * @brief Check for pending flash work (erase, staged pages, header)
+ */
+bool sample_source_flash_pending(void);
+
+/**
+ * @brief Do one step of flash work: erase one sector or program one page
+ * 
+ * Audio core only. Stalls both cores for the duration of the operation
+ * (a page program takes under a millisecond, a sector erase ~45 ms
+ * typical and up to 400 ms).
+ * 
+ * @return true if there was work to do
+ */
+bool sample_source_service(void);
+
+#endif // SAMPLE_SOURCE_H
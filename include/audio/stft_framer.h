@@ -0,0 +1,54 @@
+/**
+ * @file stft_framer.h
+ * @brief Sliding-window (overlapped) framing for the FFT
+ * 
+ * Keeps the last frame_size samples in normalized form and produces a new
+ * analysis frame every hop (frame_size * (1 - FFT_OVERLAP)) samples. Raw
+ * ADC samples are converted exactly once, when they enter the history.
+ */
+
+#ifndef STFT_FRAMER_H
+#define STFT_FRAMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio/fft_processor.h"  // fft_sample_t
+
+/**
+ * @brief Initialize framer for FFT_SIZE and clear the sample history
+ */
+void stft_framer_init(void);
+
+/**
+ * @brief Switch frame size and clear the sample history
+ * @param frame_size FFT_SIZE_MIN to FFT_SIZE_MAX, a multiple of its hop
+ * @return true if successful (false keeps the current size)
+ */
+bool stft_framer_configure(uint32_t frame_size);
+
+/**
+ * @brief Append one hop of raw ADC samples to the history
+ * @param samples stft_framer_hop_size() raw 12-bit ADC samples
+ * @return true once the history holds a full frame
+ */
+bool stft_framer_push(const uint16_t *samples);
+
+/**
+ * @brief Get the current analysis frame
+ * @return stft_framer_frame_size() contiguous normalized samples, oldest first
+ */
+const fft_sample_t *stft_framer_frame(void);
+
+/**
+ * @brief Get hop size
+ * @return Number of new samples consumed per frame
+ */
+uint32_t stft_framer_hop_size(void);
+
+/**
+ * @brief Get frame size
+ * @return Samples per analysis frame
+ */
+uint32_t stft_framer_frame_size(void);
+
+#endif // STFT_FRAMER_H
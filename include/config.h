@@ -29,6 +29,7 @@
 #define DISPLAY_HEIGHT      240
 #define DISPLAY_ROTATION    1   // 0=0°, 1=90°, 2=180°, 3=270°
 #define DISPLAY_SPI_SPEED   (32 * 1000 * 1000)  // 32 MHz
+#define DISPLAY_STRIP_HEIGHT 16  // Rows per strip-renderer line buffer (two buffers, 10 KB each)
 
 // --- Touch Controller Configuration (XPT2046) ---
 #define TOUCH_SPI_PORT      spi1
@@ -65,12 +66,37 @@
 // ============================================================================
 
 // --- Sampling Configuration ---
-#define SAMPLE_RATE_HZ      22050   // Audio sample rate (8000, 16000, 22050)
-#define FFT_SIZE            64      // Must be power of 2 (64, 128, 256)
+#define SAMPLE_RATE_HZ      22050   // Audio sample rate at boot
+#define SAMPLE_RATES_HZ     { 8000, 16000, 22050, 32000, 44100, 48000 }  // Selectable at run time
+#define ADC_PIO_PACING      1       // 1 = PIO sample clock triggers each conversion, 0 = ADC clock divider
+#ifndef FFT_SIZE                    // Overridable from the build (host benchmarks)
+#define FFT_SIZE            64      // FFT size at boot, power of 2 (64 ... 1024)
+#endif
+#ifndef FFT_SIZE_FIXED              // CMake SPECTRUM_FFT_SIZE sets both
+#define FFT_SIZE_FIXED      0       // 1 = FFT_SIZE only, kernels specialized for it
+#endif
+#if FFT_SIZE_FIXED
+#define FFT_SIZE_MIN        FFT_SIZE
+#define FFT_SIZE_MAX        FFT_SIZE
+#else
+#define FFT_SIZE_MIN        64      // Run-time size range (buffers are sized for MAX)
+#define FFT_SIZE_MAX        1024
+#endif
 #define FFT_OVERLAP         0.5f    // 50% overlap between FFT windows
 
+// Multirate analysis: low bands come from FFTs of half-band decimated input
+// (fs/2, fs/4, ...), all the same size, for finer bass resolution
+#define FFT_MULTIRATE_LEVELS_MAX 3      // Analysis rates fs, fs/2, fs/4
+#define FFT_MULTIRATE_LEVELS    3       // Levels at boot (1 = single full-rate FFT)
+#define FFT_MULTIRATE_PASSBAND  0.25f   // Band edges a level may serve, fraction of its rate
+
+// Band engine at boot (band_engine_t): full FFT or constant-Q filter bank
+#define BAND_ENGINE_DEFAULT     BAND_ENGINE_FFT
+
 // Derived values
 #define SAMPLES_PER_FFT     FFT_SIZE
+#define FFT_HOP_FOR(n)      ((uint32_t)((n) * (1.0f - FFT_OVERLAP)))  // New samples per FFT of size n
+#define FFT_HOP_SIZE        FFT_HOP_FOR(FFT_SIZE)
 #define FFT_RATE_HZ         (SAMPLE_RATE_HZ / (FFT_SIZE * (1.0f - FFT_OVERLAP)))
 #define NYQUIST_FREQ_HZ     (SAMPLE_RATE_HZ / 2)
 
@@ -85,15 +111,25 @@
 
 // --- Audio Processing Options ---
 #define WINDOW_FUNCTION     WINDOW_HANN     // HANN, HAMMING, BLACKMAN
-#define AUTO_GAIN_ENABLED   true            // Enable automatic gain control
 #define MIC_GAIN_DEFAULT    50              // 0-100%
+
+// Band dynamics (audio/band_dynamics.h), factors per display frame
+// (FRAME_TIME_US) whatever the FFT rate
+#define SMOOTHING_FACTOR    0.7f            // Temporal smoothing of rises (0=none, 1=full)
+#define SMOOTHING_RELEASE   0.85f           // Same for falls (slower decay)
 #define PEAK_DECAY_RATE     0.95f           // Peak hold decay factor per frame
 #define PEAK_HOLD_MS        1500            // Peak hold time in milliseconds
-#define SMOOTHING_FACTOR    0.7f            // Temporal smoothing (0=none, 1=full)
+#define AUTO_GAIN_ENABLED   1               // 1 = automatic gain control
+#define AGC_TARGET_LEVEL    0.8f            // Loudest band is brought towards this level
+#define AGC_MAX_GAIN        8.0f            // Gain limit (quiet input, silence)
+#define AGC_RELEASE_MS      4000            // Gain recovery time constant after loud input
 
 // FFT visualization gain (increase if bars are too small)
 // Typical values: 5.0 (high gain) to 50.0 (low gain)
 #define FFT_DISPLAY_GAIN    5.0f            // Lower = more sensitive
+#ifndef FFT_FIXED_POINT
+#define FFT_FIXED_POINT     1               // 1 = Q15 integer FFT, 0 = float reference
+#endif
 
 // ============================================================================
 // DISPLAY CONFIGURATION
@@ -126,7 +162,10 @@
 // TOUCH UI CONFIGURATION
 // ============================================================================
 
-#define TOUCH_DEBOUNCE_MS       50      // Debounce time for touch events
+#define TOUCH_DEBOUNCE_MS       50      // Release must last this long to end a touch
+#define TOUCH_SAMPLE_RATE_HZ    100     // Scans per second while the panel is touched
+#define TOUCH_MEDIAN_SAMPLES    5       // X/Y conversions per scan (median, odd)
+#define TOUCH_EVENT_QUEUE_DEPTH 8       // Gestures buffered for the display loop
 #define TOUCH_HOLD_TIME_MS      1000    // Long press threshold
 #define SWIPE_THRESHOLD_PX      50      // Minimum distance for swipe
 #define SWIPE_TIMEOUT_MS        500     // Maximum time for swipe gesture
@@ -140,17 +179,52 @@
 #define CORE_DISPLAY        1   // Core 1: Display rendering and UI
 
 // --- Buffer Sizes ---
-#define AUDIO_BUFFER_SIZE   (FFT_SIZE * 4)  // Ring buffer for audio samples
-#define FFT_RESULT_BUFFER   2               // Double buffering for FFT results
+#define AUDIO_BUFFER_SIZE   (FFT_SIZE_MAX * 2)  // Ring buffer for audio samples
+#define FFT_RESULT_BUFFER   3               // Triple buffering for FFT results (latest wins)
+#define ADC_DMA_BLOCK_SIZE  64              // Samples per ADC DMA block (one IRQ per block)
 
 // --- DMA Configuration ---
 #define DMA_CHANNEL_DISPLAY 0
-#define DMA_CHANNEL_TOUCH   1
+#define DMA_CHANNEL_TOUCH   1   // Touch SPI TX (commands), paired with TOUCH_RX
+#define DMA_CHANNEL_TOUCH_RX 5  // Touch SPI RX (results), completion on DMA_IRQ_1
+#define DMA_CHANNEL_ADC_PING 2  // ADC capture, chained with PONG
+#define DMA_CHANNEL_ADC_PONG 3  // ADC capture, chained with PING
+#define DMA_CHANNEL_ADC_TRIGGER 4  // PIO sample clock -> ADC start (ADC_PIO_PACING)
+
+// --- Binary Spectrum Stream (USB CDC, utils/spectrum_stream.h) ---
+#define STREAM_BOOT_MODE    0       // stream_mode_t at boot (0 = off, see serial 'b'/'w'/'n')
+#define STREAM_BATCH_FRAMES 4       // Band frames per packet
+#define STREAM_BUFFER_BYTES 4096    // Staging ring for the USB TX path (power of 2)
+
+// --- Sample Capture and Replay (audio/sample_source.h) ---
+#define CAPTURE_FLASH_BYTES     (1024 * 1024)   // Reserved at the end of flash (whole 4 KB sectors)
+#define CAPTURE_STAGING_BYTES   8192            // RAM staging for flash writes (power of 2)
+
+// --- Wi-Fi UDP Telemetry (Pico W, net/udp_telemetry.h) ---
+#ifndef WIFI_TELEMETRY_ENABLE
+#define WIFI_TELEMETRY_ENABLE   0   // Set by the CMake option SPECTRUM_WIFI_TELEMETRY
+#endif
+#ifndef WIFI_SSID
+#define WIFI_SSID               ""  // CMake -DWIFI_SSID=...
+#endif
+#ifndef WIFI_PASSWORD
+#define WIFI_PASSWORD           ""  // CMake -DWIFI_PASSWORD=... (empty = open network)
+#endif
+#ifndef TELEMETRY_TARGET_IP
+#define TELEMETRY_TARGET_IP     "239.255.77.77"  // Multicast group or unicast host
+#endif
+#ifndef TELEMETRY_PORT
+#define TELEMETRY_PORT          5077
+#endif
+#define TELEMETRY_FRAME_RATE_HZ 20  // Band frames sampled per second
+#define TELEMETRY_BATCH_FRAMES  4   // Frames per datagram
+#define TELEMETRY_PBUF_COUNT    4   // Pre-allocated datagram buffers
+#define TELEMETRY_RETRY_MS      10000  // Wait before rejoining after a failed join
 
 // --- Debug Options ---
 #define DEBUG_ENABLE        1
 #define DEBUG_PRINT_FPS     0
-#define DEBUG_PRINT_FFT     0
+#define PROFILE_ENABLE      DEBUG_ENABLE    // Per-stage cycle counters (utils/profiler.h)
 
 #if DEBUG_ENABLE
     #define DEBUG_PRINTF(...) printf(__VA_ARGS__)
@@ -168,6 +242,12 @@ typedef enum {
     INPUT_JACK = 1
 } audio_input_t;
 
+// Band engines (same bands[] output, selectable at run time)
+typedef enum {
+    BAND_ENGINE_FFT = 0,        // FFT (plus multirate levels), bins averaged per band
+    BAND_ENGINE_FILTERS         // One constant-Q filter per band (audio/filter_bank.h)
+} band_engine_t;
+
 // Window functions for FFT
 typedef enum {
     WINDOW_NONE = 0,
@@ -176,15 +256,7 @@ typedef enum {
     WINDOW_BLACKMAN
 } window_function_t;
 
-// Visualization themes
-typedef enum {
-    THEME_BARS = 0,
-    THEME_WATERFALL,
-    THEME_RADIAL,
-    THEME_VU_METER,
-    THEME_MIRROR,
-    THEME_COUNT  // Total number of themes
-} theme_t;
+// Visualization themes are enumerated by theme_type_t in display/theme_manager.h
 
 // ============================================================================
 // HELPER MACROS
@@ -0,0 +1,57 @@
+/**
+ * @file gfx.h
+ * @brief Integer rasterization helpers shared by the display code
+ * 
+ * Everything here works in horizontal spans so callers can fill a row
+ * at a time into a strip buffer: midpoint circle extents, row spans of
+ * thick lines, and fixed-point angle tables for radial layouts.
+ */
+
+#ifndef GFX_H
+#define GFX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define GFX_TRIG_SHIFT  14                      // sin/cos tables are Q14
+#define GFX_TRIG_ONE    (1 << GFX_TRIG_SHIFT)
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Half-width of a filled circle on each row (midpoint algorithm)
+ * @param r Radius in pixels
+ * @param extent Output: r + 1 entries, extent[dy] is the largest |dx|
+ *               drawn on row cy ± dy
+ */
+void gfx_circle_extents(uint16_t r, int16_t *extent);
+
+/**
+ * @brief Columns a thick line covers on one row
+ * 
+ * The line is the Bresenham line swept by a square brush of
+ * (2 * (thickness / 2) + 1) pixels, so consecutive rows join without gaps.
+ * 
+ * @param y Row to query
+ * @param x_start Output: first column covered
+ * @param x_end Output: last column covered (inclusive)
+ * @return false if the line does not touch row y
+ */
+bool gfx_line_span(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t thickness,
+                   int16_t y, int16_t *x_start, int16_t *x_end);
+
+/**
+ * @brief Fill cos/sin tables for count equally spaced angles
+ * 
+ * Entry i is for 2 * pi * i / count, in Q14 (GFX_TRIG_ONE = 1.0). Meant
+ * to be rebuilt only when count changes.
+ */
+void gfx_angle_table(uint8_t count, int16_t *cos_q14, int16_t *sin_q14);
+
+#endif // GFX_H
@@ -38,7 +38,9 @@
 #define ILI9341_RAMRD       0x2E
 
 #define ILI9341_PTLAR       0x30
+#define ILI9341_VSCRDEF     0x33
 #define ILI9341_MADCTL      0x36
+#define ILI9341_VSCRSADD    0x37
 #define ILI9341_PIXFMT      0x3A
 
 #define ILI9341_FRMCTR1     0xB1
@@ -127,6 +129,10 @@ void ili9341_draw_pixel(int16_t x, int16_t y, uint16_t color);
 
 /**
  * @brief Draw a filled rectangle
+ * 
+ * Streams the colour by DMA and returns as soon as the transfer is started;
+ * the next driver call waits for it.
+ * 
  * @param x X coordinate of top-left corner
  * @param y Y coordinate of top-left corner
  * @param w Width
@@ -145,6 +151,55 @@ void ili9341_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t colo
  */
 void ili9341_draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
 
+/**
+ * @brief Start a DMA copy of a pixel buffer into a screen rectangle
+ * 
+ * The rectangle must lie entirely on screen (it is not clipped). The buffer
+ * must not be modified until ili9341_is_busy() returns false or
+ * ili9341_wait() has returned.
+ * 
+ * @param x X coordinate of top-left corner
+ * @param y Y coordinate of top-left corner
+ * @param w Width
+ * @param h Height
+ * @param pixels w*h RGB565 values, row by row
+ */
+void ili9341_blit_async(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels);
+
+/**
+ * @brief Copy a pixel buffer into a screen rectangle and wait for completion
+ * @param x X coordinate of top-left corner
+ * @param y Y coordinate of top-left corner
+ * @param w Width
+ * @param h Height
+ * @param pixels w*h RGB565 values, row by row
+ */
+void ili9341_blit(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels);
+
+/**
+ * @brief Check whether a pixel transfer is still on the wire
+ * @return true while DMA or SPI is busy
+ */
+bool ili9341_is_busy(void);
+
+/**
+ * @brief Wait for the current pixel transfer (if any) and release the bus
+ */
+void ili9341_wait(void);
+
+/**
+ * @brief Keep the display selected across several drawing calls
+ * 
+ * Saves the CS toggles between primitives. Calls may nest; CS is released
+ * by the outermost ili9341_end_transaction() once the bus is idle.
+ */
+void ili9341_begin_transaction(void);
+
+/**
+ * @brief Close a transaction opened by ili9341_begin_transaction()
+ */
+void ili9341_end_transaction(void);
+
 /**
  * @brief Set address window for bulk pixel writing
  * @param x0 Start X coordinate
@@ -170,6 +225,58 @@ void ili9341_write_pixel(uint16_t color);
  */
 void ili9341_end_write(void);
 
+/**
+ * @brief Define the hardware scroll area (VSCRDEF)
+ * 
+ * Scrolling runs along the panel's 320-line axis: screen Y in portrait,
+ * screen X in landscape rotations. Fixed areas are in panel lines.
+ * 
+ * @param top_fixed Lines fixed at the start of the axis
+ * @param bottom_fixed Lines fixed at the end of the axis
+ */
+void ili9341_set_scroll_area(uint16_t top_fixed, uint16_t bottom_fixed);
+
+/**
+ * @brief Set the frame-memory line shown first in the scroll area (VSCRSADD)
+ * @param line Frame-memory line (top_fixed .. top_fixed + scroll lines - 1)
+ */
+void ili9341_scroll_to(uint16_t line);
+
+/**
+ * @brief Restore the full-screen scroll area at offset 0 (no scrolling)
+ */
+void ili9341_scroll_reset(void);
+
+/**
+ * @brief Check the scroll axis for the current rotation
+ * @return true if scrolling moves the picture along screen X
+ */
+bool ili9341_scroll_is_horizontal(void);
+
+/**
+ * @brief Map between frame-memory lines and screen coordinates
+ * 
+ * Returns the screen coordinate along the scroll axis that addresses
+ * frame-memory line @p line (the mapping is its own inverse).
+ * 
+ * @param line Frame-memory line (0 to ILI9341_TFTHEIGHT-1)
+ * @return Screen X (landscape) or Y (portrait)
+ */
+uint16_t ili9341_scroll_line_coord(uint16_t line);
+
+/**
+ * @brief Drawing coordinate that appears at a screen position right now
+ * 
+ * With the full-screen scroll area at the last ili9341_scroll_to() line,
+ * returns the coordinate along the scroll axis to draw at so the pixels
+ * show up at screen coordinate @p coord (identity when not scrolled).
+ * Consecutive coordinates stay consecutive, modulo ILI9341_TFTHEIGHT.
+ * 
+ * @param coord Screen X (landscape) or Y (portrait)
+ * @return Coordinate to draw at
+ */
+uint16_t ili9341_scroll_screen_coord(uint16_t coord);
+
 /**
  * @brief Run display test pattern
  */
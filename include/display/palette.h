@@ -0,0 +1,53 @@
+/**
+ * @file palette.h
+ * @brief Shared RGB565 colour maps for the visualization themes
+ * 
+ * Each palette is a 256-entry lookup table indexed by an 8-bit level
+ * (0 = silence, 255 = full scale), built once by palette_init().
+ */
+
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <stdint.h>
+
+// ============================================================================
+// Palettes
+// ============================================================================
+
+#define PALETTE_SIZE 256
+
+typedef enum {
+    PALETTE_LEVEL = 0,  // Green → yellow (0.5) → red (bars)
+    PALETTE_LEVEL_SOFT, // Green → yellow (0.6) → red (mirror)
+    PALETTE_HEAT,       // Black → blue → cyan → green → yellow → red (waterfall)
+    PALETTE_SPECTRUM,   // Blue → cyan → green → yellow → red (radial)
+    PALETTE_COUNT
+} palette_id_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Build all palette tables (safe to call more than once)
+ */
+void palette_init(void);
+
+/**
+ * @brief Get a palette for native RGB565 pixels (16-bit SPI / DMA)
+ * @param id Palette to look up
+ * @return PALETTE_SIZE colours indexed by level
+ */
+const uint16_t *palette_get(palette_id_t id);
+
+/**
+ * @brief Quantize an amplitude (0.0 to 1.0) to a palette level
+ */
+static inline uint8_t palette_level(float amplitude) {
+    if (amplitude <= 0.0f) return 0;
+    if (amplitude >= 1.0f) return PALETTE_SIZE - 1;
+    return (uint8_t)(amplitude * (PALETTE_SIZE - 1) + 0.5f);
+}
+
+#endif // PALETTE_H
@@ -0,0 +1,127 @@
+/**
+ * @file strip_renderer.h
+ * @brief Strip-buffered renderer with dirty-region tracking
+ * 
+ * Themes describe each frame as a list of primitives (rects, gradients,
+ * lines, rings, procedural rows) between begin_frame() and end_frame().
+ * The list is diffed against the previous frame; only the areas that
+ * changed are rasterized into DISPLAY_STRIP_HEIGHT-row line buffers, two
+ * of them, so the next strip is drawn while DMA sends the previous one.
+ * Nothing is erased on screen, so there is no flicker.
+ */
+
+#ifndef STRIP_RENDERER_H
+#define STRIP_RENDERER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Gradient direction relative to its origin row
+ */
+typedef enum {
+    GRADIENT_DOWN = 0,  // Row y uses colors[y - origin]
+    GRADIENT_UP         // Row y uses colors[origin - y]
+} gradient_dir_t;
+
+/**
+ * @brief Row callback for procedurally rendered regions
+ * @param y Screen row
+ * @param x First screen column to produce
+ * @param count Number of pixels to produce
+ * @param pixels Output: count RGB565 values for columns x .. x+count-1
+ */
+typedef void (*strip_row_fn_t)(int16_t y, int16_t x, uint16_t count, uint16_t *pixels);
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Initialize renderer for the current display size and rotation
+ */
+void strip_renderer_init(void);
+
+/**
+ * @brief Start collecting primitives for a new frame
+ * @param background RGB565 colour under all primitives
+ */
+void strip_renderer_begin_frame(uint16_t background);
+
+/**
+ * @brief Add a filled rectangle
+ * 
+ * A rect with h <= 0 draws nothing but keeps its place in the list, so a
+ * bar or marker that is sometimes empty still diffs against itself and
+ * only the rows between its old and new edge are repainted.
+ */
+void strip_renderer_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+/**
+ * @brief Add a rectangle filled with one colour per row
+ * 
+ * The colour table is referenced, not copied: it must stay valid until
+ * end_frame() and must not change between frames without also changing
+ * the pointer (or calling strip_renderer_invalidate()). Like rects, an
+ * empty gradient (h <= 0) keeps its place in the list.
+ * 
+ * @param colors Colour table indexed by distance from origin
+ * @param origin Row where index 0 applies (rows before it are skipped)
+ * @param dir Whether the index grows downward or upward from origin
+ */
+void strip_renderer_gradient(int16_t x, int16_t y, int16_t w, int16_t h,
+                             const uint16_t *colors, int16_t origin, gradient_dir_t dir);
+
+/**
+ * @brief Add a line
+ * @param thickness Line width in pixels (1 = hairline)
+ */
+void strip_renderer_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                         uint16_t color, uint8_t thickness);
+
+/**
+ * @brief Add a filled ring (r_inner = 0 gives a disc)
+ */
+void strip_renderer_ring(int16_t cx, int16_t cy, int16_t r_inner, int16_t r_outer, uint16_t color);
+
+/**
+ * @brief Add a region whose pixels come from a row callback
+ * @param row_fn Produces pixels on demand while strips are rasterized
+ * @param version Change whenever the content changes; same version means
+ *                the region is left untouched on screen
+ */
+void strip_renderer_rows(int16_t x, int16_t y, int16_t w, int16_t h,
+                         strip_row_fn_t row_fn, uint16_t version);
+
+/**
+ * @brief Diff against the previous frame and push the changed strips
+ * 
+ * The last strip is still in flight over DMA when this returns.
+ * 
+ * @return Number of dirty rectangles sent
+ */
+uint16_t strip_renderer_end_frame(void);
+
+/**
+ * @brief Redraw the whole screen on the next end_frame()
+ * 
+ * Needed after anything else draws to the display directly.
+ */
+void strip_renderer_invalidate(void);
+
+/**
+ * @brief Clear the screen with a DMA fill and draw the next frame over it
+ * 
+ * Returns while the fill is still streaming. The next end_frame() then
+ * only rasterizes what its primitives cover instead of every strip. Call
+ * between frames.
+ * 
+ * @param background RGB565 colour of the fill (use it for the next frame)
+ */
+void strip_renderer_clear(uint16_t background);
+
+#endif // STRIP_RENDERER_H
@@ -40,6 +40,12 @@ theme_type_t theme_manager_get_current(void);
 
 /**
  * @brief Set theme by type
+ * 
+ * The old theme is suspended and keeps its state; the new one resumes
+ * from its own. Never waits for the display: the screen is cleared by an
+ * async DMA fill (or, for themes that cover every pixel, repainted with
+ * the next frame).
+ * 
  * @param theme Theme to activate
  */
 void theme_manager_set_theme(theme_type_t theme);
@@ -62,10 +68,14 @@ const char* theme_manager_get_name(void);
 
 /**
  * @brief Render current theme
- * @param bands Array of frequency band amplitudes (0.0 to 1.0)
+ * 
+ * Themes only draw: smoothing and peak hold come with the levels.
+ * 
+ * @param levels Smoothed band levels (Q8.8 palette levels, band_dynamics)
+ * @param peaks Peak-hold levels (same scale)
  * @param num_bands Number of frequency bands
  */
-void theme_manager_render(const float *bands, uint8_t num_bands);
+void theme_manager_render(const uint16_t *levels, const uint16_t *peaks, uint8_t num_bands);
 
 /**
  * @brief Show theme name overlay on screen
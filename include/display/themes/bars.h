@@ -7,6 +7,12 @@
 #define BARS_H
 
 #include <stdint.h>
+#include "display/themes/theme.h"
+
+/**
+ * @brief Theme table for theme_manager
+ */
+extern const theme_t bars_theme;
 
 /**
  * @brief Initialize bars visualization
@@ -15,13 +21,16 @@ void bars_init(void);
 
 /**
  * @brief Render bars visualization
- * @param bands Array of frequency band amplitudes (0.0 to 1.0)
+ * 
+ * Adds primitives to the current strip_renderer frame.
+ * @param levels Smoothed band levels (Q8.8 palette levels, band_dynamics)
+ * @param peaks Peak-hold levels (same scale)
  * @param num_bands Number of frequency bands
  */
-void bars_render(const float *bands, uint8_t num_bands);
+void bars_render(const uint16_t *levels, const uint16_t *peaks, uint8_t num_bands);
 
 /**
- * @brief Clear the display and reset state
+ * @brief Repaint the display on the next frame and reset state
  */
 void bars_clear(void);
 
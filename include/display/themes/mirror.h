@@ -10,6 +10,12 @@
 #define MIRROR_H
 
 #include <stdint.h>
+#include "display/themes/theme.h"
+
+/**
+ * @brief Theme table for theme_manager
+ */
+extern const theme_t mirror_theme;
 
 /**
  * @brief Initialize mirror visualization
@@ -18,13 +24,16 @@ void mirror_init(void);
 
 /**
  * @brief Render mirror visualization
- * @param bands Array of frequency band amplitudes (0.0 to 1.0)
+ * 
+ * Adds primitives to the current strip_renderer frame.
+ * @param levels Smoothed band levels (Q8.8 palette levels, band_dynamics)
+ * @param peaks Peak-hold levels (same scale)
  * @param num_bands Number of frequency bands
  */
-void mirror_render(const float *bands, uint8_t num_bands);
+void mirror_render(const uint16_t *levels, const uint16_t *peaks, uint8_t num_bands);
 
 /**
- * @brief Clear the display and reset state
+ * @brief Repaint the display on the next frame and reset state
  */
 void mirror_clear(void);
 
@@ -0,0 +1,48 @@
+/**
+ * @file theme.h
+ * @brief Interface every visualization theme implements
+ * 
+ * theme_manager drives the current theme only through this table. Themes
+ * are initialized once and keep their state while another theme is shown:
+ * switching suspends the old theme and resumes the new one, which then
+ * redraws from what it retained.
+ */
+
+#ifndef THEME_H
+#define THEME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    const char *name;
+
+    /**
+     * @brief Set up state (once, from theme_manager_init())
+     */
+    void (*init)(void);
+
+    /**
+     * @brief Add this frame's primitives to the current strip_renderer frame
+     * @param levels Smoothed band levels (Q8.8 palette levels, band_dynamics)
+     * @param peaks Peak-hold levels (same scale)
+     * @param num_bands Number of frequency bands
+     */
+    void (*render)(const uint16_t *levels, const uint16_t *peaks, uint8_t num_bands);
+
+    /**
+     * @brief Become the current theme (NULL if nothing to restore)
+     */
+    void (*resume)(void);
+
+    /**
+     * @brief Stop being the current theme, keeping state (NULL if nothing to do)
+     */
+    void (*suspend)(void);
+
+    // Draws every pixel each frame: a switch repaints it in one pass
+    // instead of clearing the screen first
+    bool opaque;
+} theme_t;
+
+#endif // THEME_H
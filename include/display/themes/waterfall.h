@@ -10,6 +10,12 @@
 #define WATERFALL_H
 
 #include <stdint.h>
+#include "display/themes/theme.h"
+
+/**
+ * @brief Theme table for theme_manager
+ */
+extern const theme_t waterfall_theme;
 
 /**
  * @brief Initialize waterfall visualization
@@ -18,13 +24,17 @@ void waterfall_init(void);
 
 /**
  * @brief Render waterfall visualization
- * @param bands Array of frequency band amplitudes (0.0 to 1.0)
+ * 
+ * Writes the newest line and advances the hardware scroll; the history is
+ * registered with the current strip_renderer frame for repaints.
+ * @param levels Smoothed band levels (Q8.8 palette levels, band_dynamics)
+ * @param peaks Peak-hold levels (unused)
  * @param num_bands Number of frequency bands
  */
-void waterfall_render(const float *bands, uint8_t num_bands);
+void waterfall_render(const uint16_t *levels, const uint16_t *peaks, uint8_t num_bands);
 
 /**
- * @brief Clear the display and reset state
+ * @brief Repaint the display on the next frame and reset state
  */
 void waterfall_clear(void);
 
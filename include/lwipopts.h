@@ -0,0 +1,54 @@
+/**
+ * @file lwipopts.h
+ * @brief lwIP configuration for the Wi-Fi telemetry build (net/udp_telemetry.h)
+ *
+ * Polled, single-threaded lwIP (pico_cyw43_arch_lwip_poll, NO_SYS): every
+ * lwIP call happens on the display core. Telemetry only sends UDP; DHCP,
+ * ARP and ICMP (ping) are the rest of the stack in use.
+ */
+
+#ifndef LWIPOPTS_H
+#define LWIPOPTS_H
+
+// --- System ---
+#define NO_SYS                      1
+#define LWIP_SOCKET                 0
+#define LWIP_NETCONN                0
+#define MEM_LIBC_MALLOC             0
+#define MEM_ALIGNMENT               4
+#define MEM_SIZE                    4000    // Heap for PBUF_RAM (telemetry pbufs come from here)
+#define MEMP_NUM_ARP_QUEUE          4
+#define PBUF_POOL_SIZE              16      // Receive buffers
+#define LWIP_CHKSUM_ALGORITHM       3
+
+// --- Protocols ---
+#define LWIP_IPV4                   1
+#define LWIP_ARP                    1
+#define LWIP_ETHERNET               1
+#define LWIP_ICMP                   1
+#define LWIP_RAW                    1
+#define LWIP_UDP                    1
+#define LWIP_DHCP                   1
+#define LWIP_DHCP_DOES_ACD_CHECK    0
+#define DHCP_DOES_ARP_CHECK         0
+#define LWIP_DNS                    0
+
+// TCP is unused; kept at minimal buffers
+#define LWIP_TCP                    1
+#define TCP_MSS                     536
+#define TCP_WND                     (2 * TCP_MSS)
+#define TCP_SND_BUF                 (2 * TCP_MSS)
+#define TCP_SND_QUEUELEN            ((4 * (TCP_SND_BUF) + (TCP_MSS - 1)) / (TCP_MSS))
+
+// --- Network interface (CYW43 driver requirements) ---
+#define LWIP_NETIF_STATUS_CALLBACK  1
+#define LWIP_NETIF_LINK_CALLBACK    1
+#define LWIP_NETIF_HOSTNAME         1
+#define LWIP_NETIF_TX_SINGLE_PBUF   1
+
+// --- Statistics and debug off ---
+#define LWIP_STATS                  0
+#define LWIP_STATS_DISPLAY          0
+#define LWIP_DEBUG                  0
+
+#endif // LWIPOPTS_H
@@ -0,0 +1,69 @@
+/**
+ * @file udp_telemetry.h
+ * @brief Wi-Fi UDP telemetry of band frames (Pico W, CYW43 + lwIP)
+ * 
+ * Samples the displayed band frames at TELEMETRY_FRAME_RATE_HZ, batches
+ * TELEMETRY_BATCH_FRAMES of them per datagram in the spectrum stream packet
+ * format (utils/spectrum_stream.h, uint8 bands) and sends each batch to
+ * TELEMETRY_TARGET_IP:TELEMETRY_PORT, unicast or multicast. Analyzers are
+ * told apart by their source address.
+ * 
+ * Runs entirely on the display core in lwIP's polled (NO_SYS) mode:
+ * udp_telemetry_service() is a scheduler task there and drives the CYW43
+ * driver, the connection and the sends. Datagrams are built in place in
+ * TELEMETRY_PBUF_COUNT pbufs allocated once at init. Frames that find no
+ * free pbuf, and batches lwIP refuses, are dropped and counted; nothing
+ * ever waits for the network.
+ * 
+ * Built only with WIFI_TELEMETRY_ENABLE (CMake option
+ * SPECTRUM_WIFI_TELEMETRY); otherwise every call is a no-op.
+ */
+
+#ifndef UDP_TELEMETRY_H
+#define UDP_TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Bring up the CYW43 and start joining WIFI_SSID (non-blocking join)
+ * 
+ * Call on the core that will run udp_telemetry_service(), after the other
+ * drivers have claimed their fixed DMA channels.
+ * 
+ * @return true if successful (false: no telemetry in this build, or the
+ *         wireless chip failed to start)
+ */
+bool udp_telemetry_init(void);
+
+/**
+ * @brief Offer the newest band frame (copied; sent at the telemetry rate)
+ * @param bands Display levels (0.0 to 1.0)
+ * @param num_bands Number of bands (1 to BAND_COUNT_MAX)
+ */
+void udp_telemetry_offer(const float *bands, uint8_t num_bands);
+
+/**
+ * @brief Poll the network, (re)connect, sample frames and send batches
+ * 
+ * Call every few milliseconds. Never blocks.
+ * 
+ * @return true if a datagram was sent or dropped
+ */
+bool udp_telemetry_service(void);
+
+/**
+ * @brief Check whether the Wi-Fi link is up with an address
+ */
+bool udp_telemetry_connected(void);
+
+/**
+ * @brief Band frames dropped since init (congestion or no pbuf free)
+ */
+uint32_t udp_telemetry_dropped(void);
+
+#endif // UDP_TELEMETRY_H
@@ -4,6 +4,10 @@
  * 
  * Driver for XPT2046 touch controller commonly found on
  * ILI9341 TFT display modules.
+ * 
+ * Sampling is interrupt driven: the pen-down IRQ starts DMA scans at
+ * TOUCH_SAMPLE_RATE_HZ, and gestures are queued for the caller. None of
+ * the functions below touch the SPI bus or block.
  */
 
 #ifndef XPT2046_H
@@ -43,19 +47,23 @@ typedef enum {
 
 /**
  * @brief Initialize XPT2046 touch controller
+ * 
+ * Touch interrupts and the sample timer run on the calling core.
+ * 
  * @return true if successful
  */
 bool xpt2046_init(void);
 
 /**
- * @brief Read current touch point
- * @param point Output touch point data
+ * @brief Read the latest filtered touch point
+ * @param point Output touch point data (last pressed position, with
+ *              is_pressed cleared once the pen is up)
  * @return true if touch detected
  */
 bool xpt2046_read(touch_point_t *point);
 
 /**
- * @brief Check if screen is currently touched
+ * @brief Check if screen is currently touched (as of the latest scan)
  * @return true if touched
  */
 bool xpt2046_is_touched(void);
@@ -71,8 +79,8 @@ void xpt2046_calibrate(uint16_t raw_x, uint16_t raw_y,
                        uint16_t *screen_x, uint16_t *screen_y);
 
 /**
- * @brief Detect gesture from touch events
- * @return Detected gesture type
+ * @brief Take the oldest gesture from the event queue
+ * @return Detected gesture type (GESTURE_NONE if the queue is empty)
  */
 touch_gesture_t xpt2046_detect_gesture(void);
 
@@ -0,0 +1,56 @@
+/**
+ * @file band_buffer.h
+ * @brief Latest-wins triple buffer for passing band results between cores
+ * 
+ * The audio core publishes a band array after every FFT; the display core
+ * picks up the newest one whenever it is ready to draw. Neither side ever
+ * waits for the other: a slow renderer just skips intermediate results.
+ */
+
+#ifndef BAND_BUFFER_H
+#define BAND_BUFFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+// ============================================================================
+// Band Frame
+// ============================================================================
+
+typedef struct {
+    float bands[BAND_COUNT_MAX];      // Band engine amplitudes (0.0 to 1.0)
+    uint16_t levels[BAND_COUNT_MAX];  // Smoothed display levels (band_dynamics, Q8.8)
+    uint16_t peaks[BAND_COUNT_MAX];   // Peak-hold levels (band_dynamics, Q8.8)
+    uint8_t num_bands;                // Valid entries in each array
+    uint32_t sequence;                // Publish counter (gaps = skipped frames)
+} band_frame_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Initialize buffer (call once, before either core uses it)
+ */
+void band_buffer_init(void);
+
+/**
+ * @brief Get the frame the producer should fill next
+ * @return Producer-owned frame, valid until band_buffer_publish()
+ */
+band_frame_t *band_buffer_begin_write(void);
+
+/**
+ * @brief Publish the frame returned by band_buffer_begin_write()
+ */
+void band_buffer_publish(void);
+
+/**
+ * @brief Get the newest published frame
+ * @return Consumer-owned frame valid until the next call, or NULL if nothing
+ *         new was published since the last call
+ */
+const band_frame_t *band_buffer_acquire(void);
+
+#endif // BAND_BUFFER_H
@@ -0,0 +1,151 @@
+/**
+ * @file profiler.h
+ * @brief Per-stage cycle profiling for both cores
+ * 
+ * Scopes are timed with the core's own SysTick (one count per CPU cycle),
+ * so a scope must be shorter than 2^24 cycles (~134 ms at 125 MHz). Each
+ * stage keeps a histogram per core from which p50/p99 are reported, plus
+ * the exact maximum. Rendering cost is also kept per theme.
+ * 
+ * A stage or counter must only be recorded from one core at a time; the
+ * dump may run on either core and reads the numbers without locking.
+ * 
+ * With PROFILE_ENABLE 0 (follows DEBUG_ENABLE) the scope macros and all
+ * calls compile to nothing.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef enum {
+    PROF_ADC = 0,       // Core 0: STFT framing of one hop
+    PROF_FFT,           // Core 0: FFT and magnitude spectrum
+    PROF_BANDS,         // Core 0: band extraction and compression
+    PROF_DYNAMICS,      // Core 0: smoothing, peak hold and AGC
+    PROF_TOUCH,         // Core 1: touch polling and gesture detection
+    PROF_RENDER,        // Core 1: theme building its primitives
+    PROF_TRANSFER,      // Core 1: diff, rasterize and send strips
+    PROF_FRAME,         // Core 1: render task (overlay, theme and transfer)
+    PROF_STAGE_COUNT
+} prof_stage_t;
+
+typedef enum {
+    PROF_COUNT_ADC_OVERRUNS = 0,    // Samples dropped by the ADC ring (core 0)
+    PROF_COUNT_FFT_FAILURES,        // Band extractions that failed (core 0)
+    PROF_COUNT_FRAMES_SKIPPED,      // Band frames replaced before display (core 1)
+    PROF_COUNT_FRAMES_DROPPED,      // Render periods dropped by the scheduler (core 1)
+    PROF_COUNTER_COUNT
+} prof_counter_t;
+
+#define PROFILER_MAX_THEMES 8
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+#if PROFILE_ENABLE
+
+#include "hardware/structs/systick.h"
+
+/**
+ * @brief Clear all statistics and start the calling core's cycle counter
+ */
+void profiler_init(void);
+
+/**
+ * @brief Start the cycle counter on the calling core (other core only)
+ */
+void profiler_start_core(void);
+
+/**
+ * @brief Current cycle count (SysTick counts down, 24 bits)
+ */
+static inline uint32_t profiler_cycles(void) {
+    return systick_hw->cvr;
+}
+
+/**
+ * @brief Cycles since a profiler_cycles() value
+ */
+static inline uint32_t profiler_elapsed(uint32_t start) {
+    return (start - systick_hw->cvr) & 0x00FFFFFF;
+}
+
+/**
+ * @brief Add one duration to a stage on the calling core
+ */
+void profiler_record(prof_stage_t stage, uint32_t cycles);
+
+/**
+ * @brief Add one frame duration to a theme
+ */
+void profiler_record_theme(uint8_t theme, uint32_t cycles);
+
+/**
+ * @brief Label a theme in the dump (name must stay valid)
+ */
+void profiler_name_theme(uint8_t theme, const char *name);
+
+/**
+ * @brief Set a counter to an absolute value (for cumulative sources)
+ */
+void profiler_set_counter(prof_counter_t counter, uint32_t value);
+
+/**
+ * @brief Add to a counter
+ */
+void profiler_add_counter(prof_counter_t counter, uint32_t delta);
+
+/**
+ * @brief Print all stages, themes and counters to stdio
+ */
+void profiler_dump(void);
+
+/**
+ * @brief Clear stages and themes (counters are kept)
+ */
+void profiler_reset(void);
+
+/**
+ * @brief Handle a serial command character
+ * 
+ * 'p' dumps the profile, 'r' resets it.
+ * 
+ * @param c Character read from stdio
+ * @return true if the character was a profiler command
+ */
+bool profiler_handle_command(int c);
+
+// Time the code between BEGIN and END with the same name
+#define PROFILE_BEGIN(name)             uint32_t _profile_##name = profiler_cycles()
+#define PROFILE_END(name, stage)        profiler_record((stage), profiler_elapsed(_profile_##name))
+#define PROFILE_END_THEME(name, theme)  profiler_record_theme((theme), profiler_elapsed(_profile_##name))
+
+#else
+
+static inline void profiler_init(void) {}
+static inline void profiler_start_core(void) {}
+static inline void profiler_record(prof_stage_t stage, uint32_t cycles) { (void)stage; (void)cycles; }
+static inline void profiler_record_theme(uint8_t theme, uint32_t cycles) { (void)theme; (void)cycles; }
+static inline void profiler_name_theme(uint8_t theme, const char *name) { (void)theme; (void)name; }
+static inline void profiler_set_counter(prof_counter_t counter, uint32_t value) { (void)counter; (void)value; }
+static inline void profiler_add_counter(prof_counter_t counter, uint32_t delta) { (void)counter; (void)delta; }
+static inline void profiler_dump(void) {}
+static inline void profiler_reset(void) {}
+static inline bool profiler_handle_command(int c) { (void)c; return false; }
+
+#define PROFILE_BEGIN(name)             ((void)0)
+#define PROFILE_END(name, stage)        ((void)0)
+#define PROFILE_END_THEME(name, theme)  ((void)0)
+
+#endif // PROFILE_ENABLE
+
+#endif // PROFILER_H
@@ -0,0 +1,118 @@
+/**
+ * @file scheduler.h
+ * @brief Cooperative per-core task scheduler
+ * 
+ * Each core runs one scheduler with a handful of tasks, in priority order
+ * (the order they were added):
+ * 
+ * - Event tasks run whenever their ready() check reports work, e.g. a
+ *   sample block in the ADC ring
+ * - Periodic tasks run once per period on a fixed grid. A task that falls
+ *   a whole period or more behind never runs in a burst to catch up: the
+ *   missed periods are dropped (and counted, for skippable tasks such as
+ *   rendering, as dropped frames)
+ * 
+ * After every task run the scan restarts from the highest priority, so an
+ * expensive low-priority task delays the others by at most one run. When
+ * nothing is due the core sleeps until the next period or interrupt.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHEDULER_MAX_TASKS 6
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Task body
+ * @return true if the task did work (false: nothing to do, e.g. no new
+ *         band frame to render; not counted as a run)
+ */
+typedef bool (*sched_run_fn)(void);
+
+/**
+ * @brief Event task readiness check (cheap, called every scan)
+ */
+typedef bool (*sched_ready_fn)(void);
+
+typedef struct {
+    const char *name;
+    sched_run_fn run;
+    sched_ready_fn ready;       // Event task if set, periodic otherwise
+    uint32_t period_us;         // Periodic tasks only
+    bool skippable;             // Count dropped periods as dropped frames
+
+    // Scheduler state
+    uint64_t next_due_us;       // Start of the current period
+
+    // Statistics since the last scheduler_reset_stats()
+    uint32_t runs;              // Runs that did work
+    uint32_t dropped;           // Periods dropped (skippable tasks)
+    uint32_t max_us;            // Longest run
+    uint64_t busy_us;           // Total time in run()
+} sched_task_t;
+
+typedef struct {
+    sched_task_t tasks[SCHEDULER_MAX_TASKS];
+    uint8_t num_tasks;
+    uint64_t stats_start_us;
+    uint64_t idle_us;           // Time asleep since the last stats reset
+} scheduler_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Initialize an empty scheduler
+ */
+void scheduler_init(scheduler_t *sched);
+
+/**
+ * @brief Add an event task (runs whenever ready() returns true)
+ * @return Task handle, or NULL if the scheduler is full
+ */
+sched_task_t *scheduler_add_event(scheduler_t *sched, const char *name,
+                                  sched_run_fn run, sched_ready_fn ready);
+
+/**
+ * @brief Add a periodic task
+ * @param period_us Period in microseconds
+ * @param skippable Report missed periods as dropped frames
+ * @return Task handle, or NULL if the scheduler is full
+ */
+sched_task_t *scheduler_add_periodic(scheduler_t *sched, const char *name,
+                                     sched_run_fn run, uint32_t period_us, bool skippable);
+
+/**
+ * @brief Run the highest-priority task that is due, or sleep if none is
+ * 
+ * Call in a loop. Sleeps at most until the next periodic task is due, and
+ * wakes early on any interrupt (which is how event tasks get noticed).
+ */
+void scheduler_run_once(scheduler_t *sched);
+
+/**
+ * @brief Run tasks forever
+ */
+void scheduler_run(scheduler_t *sched) __attribute__((noreturn));
+
+/**
+ * @brief Clear run/drop/time statistics of all tasks
+ */
+void scheduler_reset_stats(scheduler_t *sched);
+
+/**
+ * @brief Print per-task rate, drops, worst-case time and CPU share
+ * 
+ * One line per task, covering the time since the last stats reset.
+ */
+void scheduler_print_stats(const scheduler_t *sched);
+
+#endif // SCHEDULER_H
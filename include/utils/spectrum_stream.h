@@ -0,0 +1,155 @@
+/**
+ * @file spectrum_stream.h
+ * @brief Binary spectrum streaming over USB CDC
+ * 
+ * The audio core quantizes every band frame (and optionally the FFT
+ * magnitude bins) into framed packets and stages them in a lock-free
+ * ring. The display core drains the ring into the USB CDC endpoint only as
+ * far as the endpoint has room, so a slow or absent host costs packets,
+ * never time: the analyzer loop never waits for USB.
+ * 
+ * Packet (little-endian):
+ * 
+ *   offset  size  field
+ *   0       2     sync 0xA5 0x5A
+ *   2       1     type (stream_packet_type_t)
+ *   3       1     records in this packet
+ *   4       2     sequence (per packet; gaps = packets dropped)
+ *   6       2     payload bytes
+ *   8       n     payload (records)
+ *   8+n     2     CRC-16/CCITT-FALSE over bytes 2 .. 8+n-1
+ * 
+ * Records:
+ * 
+ * - STREAM_PACKET_BANDS8 / BANDS16: u32 timestamp_us, u8 band count, then
+ *   one u8 (0..255) or u16 (0..65535) display level per band.
+ *   STREAM_BATCH_FRAMES frames share a packet.
+ * - STREAM_PACKET_BINS16: u32 timestamp_us, u32 sample rate, u16 bin count
+ *   (N/2), then one u16 linear magnitude per bin (Q16, FFT_DISPLAY_GAIN
+ *   applied, saturated). One spectrum per packet.
+ * 
+ * Timestamps are the low 32 bits of time since boot in microseconds.
+ * Console text can appear between packets; hosts resynchronize on the sync
+ * bytes and CRC (see scripts/stream_decoder.py).
+ */
+
+#ifndef SPECTRUM_STREAM_H
+#define SPECTRUM_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STREAM_SYNC0 0xA5
+#define STREAM_SYNC1 0x5A
+#define STREAM_HEADER_BYTES 8
+#define STREAM_CRC_BYTES 2
+
+// Packet size for payload_bytes of records, and one band record's size
+#define STREAM_PACKET_BYTES(payload_bytes) (STREAM_HEADER_BYTES + (payload_bytes) + STREAM_CRC_BYTES)
+#define STREAM_BAND_RECORD_BYTES(num_bands, bytes_per_band) (4 + 1 + (num_bands) * (bytes_per_band))
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef enum {
+    STREAM_PACKET_BANDS8 = 1,
+    STREAM_PACKET_BANDS16 = 2,
+    STREAM_PACKET_BINS16 = 3
+} stream_packet_type_t;
+
+typedef enum {
+    STREAM_OFF = 0,
+    STREAM_BANDS8,          // Bands as uint8
+    STREAM_BANDS16,         // Bands as uint16
+    STREAM_BANDS_BINS,      // Bands as uint16 plus magnitude bins (FFT engine)
+    STREAM_MODE_COUNT
+} stream_mode_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Initialize the stream (mode STREAM_BOOT_MODE)
+ */
+void spectrum_stream_init(void);
+
+/**
+ * @brief Select what is streamed (any core)
+ * 
+ * The producer starts a new batch with the next frame.
+ */
+void spectrum_stream_set_mode(stream_mode_t mode);
+
+/**
+ * @brief Get the current stream mode
+ */
+stream_mode_t spectrum_stream_get_mode(void);
+
+/**
+ * @brief Producer: add one band frame
+ * 
+ * Quantizes into the current batch and stages the packet once
+ * STREAM_BATCH_FRAMES frames are in. No-op while the stream is off.
+ * 
+ * @param bands Display levels (0.0 to 1.0)
+ * @param num_bands Number of bands (1 to BAND_COUNT_MAX)
+ * @param timestamp_us Time of the frame
+ */
+void spectrum_stream_push_bands(const float *bands, uint8_t num_bands, uint32_t timestamp_us);
+
+/**
+ * @brief Producer: add one magnitude spectrum as its own packet
+ * 
+ * No-op unless the mode is STREAM_BANDS_BINS.
+ * 
+ * @param bins Magnitudes (see fft_processor_get_magnitudes())
+ * @param num_bins Number of bins (up to FFT_SIZE_MAX / 2)
+ * @param sample_rate_hz Sample rate of the FFT (bin spacing = rate / 2 / num_bins)
+ * @param timestamp_us Time of the frame
+ */
+void spectrum_stream_push_bins(const uint16_t *bins, uint16_t num_bins,
+                               uint32_t sample_rate_hz, uint32_t timestamp_us);
+
+/**
+ * @brief Consumer: move staged bytes to USB CDC (never blocks)
+ * 
+ * Writes only as much as the CDC TX buffer has room for. Without a
+ * connected host staged packets are discarded.
+ * 
+ * @return true if any data was written or discarded
+ */
+bool spectrum_stream_service(void);
+
+/**
+ * @brief Packets dropped because the staging ring was full
+ */
+uint32_t spectrum_stream_dropped(void);
+
+// ============================================================================
+// Packet Encoding (also used by other transports, e.g. net/udp_telemetry)
+// ============================================================================
+
+/**
+ * @brief Write one band record
+ * @param dst Record position (STREAM_BAND_RECORD_BYTES() bytes)
+ * @param type STREAM_PACKET_BANDS8 or STREAM_PACKET_BANDS16
+ * @return Bytes written
+ */
+uint32_t spectrum_stream_encode_bands(uint8_t *dst, stream_packet_type_t type, const float *bands,
+                                      uint8_t num_bands, uint32_t timestamp_us);
+
+/**
+ * @brief Fill in header and CRC around the records of a packet
+ * 
+ * Needs spectrum_stream_init() first (it builds the CRC table).
+ * 
+ * @param packet Packet start; payload_bytes of records at STREAM_HEADER_BYTES,
+ *               STREAM_CRC_BYTES free after them
+ * @return Total packet length
+ */
+uint32_t spectrum_stream_seal_packet(uint8_t *packet, stream_packet_type_t type, uint8_t records,
+                                     uint16_t sequence, uint32_t payload_bytes);
+
+#endif // SPECTRUM_STREAM_H
@@ -0,0 +1,155 @@
+/**
+ * @file spsc_ring.h
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ * 
+ * Fixed-size elements in a power-of-2 ring. The producer owns the head
+ * (elements written), the consumer owns the tail (elements read); each
+ * side only ever writes its own index, and a memory barrier orders the
+ * element data against every index update. That makes the ring safe
+ * between an IRQ and the main loop as well as between the two cores,
+ * without locks or disabling interrupts.
+ * 
+ * Besides bulk copy in and out, both sides can work in place (DMA targets,
+ * zero-copy views) using the pointer accessors plus commit/release.
+ * 
+ * Indices count elements since the last reset and wrap at 2^32; ring
+ * positions are (index & mask).
+ * 
+ * The inline accessors are forced inline so they end up in RAM with a
+ * __not_in_flash_func caller (the ADC DMA IRQ keeps running while flash
+ * is being erased or programmed), whatever the build type.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/sync.h"
+
+// ============================================================================
+// Ring Structure
+// ============================================================================
+
+typedef struct {
+    uint8_t *buffer;            // capacity * element_size bytes
+    uint32_t element_size;      // Bytes per element
+    uint32_t capacity;          // Elements, power of 2
+    uint32_t mask;              // capacity - 1
+    volatile uint32_t head;     // Elements written (producer owned)
+    volatile uint32_t tail;     // Elements read (consumer owned)
+    volatile uint32_t overruns; // Elements the producer had to drop (producer owned)
+} spsc_ring_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Initialize a ring over caller-provided storage
+ * @param ring Ring to initialize
+ * @param buffer Storage for capacity * element_size bytes
+ * @param element_size Bytes per element
+ * @param capacity Number of elements (power of 2)
+ * @return true if successful
+ */
+bool spsc_ring_init(spsc_ring_t *ring, void *buffer, uint32_t element_size, uint32_t capacity);
+
+/**
+ * @brief Empty the ring, keeping the overrun count
+ * 
+ * Only while neither side is using the ring. Both indices restart at 0,
+ * so positions are aligned to any power of 2 afterwards.
+ */
+void spsc_ring_reset(spsc_ring_t *ring);
+
+/**
+ * @brief Producer: copy elements in
+ * 
+ * Elements that do not fit are dropped and counted as overruns; the
+ * consumer's data is never overwritten.
+ * 
+ * @return Number of elements pushed
+ */
+uint32_t spsc_ring_push(spsc_ring_t *ring, const void *items, uint32_t count);
+
+/**
+ * @brief Consumer: copy elements out
+ * @return Number of elements popped (at most count)
+ */
+uint32_t spsc_ring_pop(spsc_ring_t *ring, void *items, uint32_t count);
+
+/**
+ * @brief Consumer: number of elements ready to read
+ */
+static __force_inline uint32_t spsc_ring_available(const spsc_ring_t *ring) {
+    return ring->head - ring->tail;
+}
+
+/**
+ * @brief Producer: number of free element slots
+ */
+static __force_inline uint32_t spsc_ring_free(const spsc_ring_t *ring) {
+    return ring->capacity - (ring->head - ring->tail);
+}
+
+/**
+ * @brief Producer: slot of the element offset elements past the head
+ * 
+ * Lets the producer fill slots in place (e.g. by DMA) before committing
+ * them. The caller must check spsc_ring_free() and must not cross the end
+ * of the ring (see spsc_ring_index()).
+ */
+static __force_inline void *spsc_ring_write_ptr(const spsc_ring_t *ring, uint32_t offset) {
+    return ring->buffer + ((ring->head + offset) & ring->mask) * ring->element_size;
+}
+
+/**
+ * @brief Producer: publish elements filled in place
+ */
+static __force_inline void spsc_ring_commit(spsc_ring_t *ring, uint32_t count) {
+    __dmb();  // Element data visible before the new head
+    ring->head += count;
+}
+
+/**
+ * @brief Producer: count elements dropped before they reached the ring
+ */
+static __force_inline void spsc_ring_add_overruns(spsc_ring_t *ring, uint32_t count) {
+    ring->overruns += count;
+}
+
+/**
+ * @brief Consumer: view of the elements starting at the tail
+ * 
+ * Valid for spsc_ring_available() elements, up to the end of the ring,
+ * until released. Call only after spsc_ring_available() reported them.
+ */
+static __force_inline const void *spsc_ring_read_ptr(const spsc_ring_t *ring) {
+    __dmb();  // Don't let element loads run ahead of the head check
+    return ring->buffer + (ring->tail & ring->mask) * ring->element_size;
+}
+
+/**
+ * @brief Consumer: hand elements read in place back to the producer
+ */
+static __force_inline void spsc_ring_release(spsc_ring_t *ring, uint32_t count) {
+    __dmb();  // Reads of the elements complete before the slots are reused
+    ring->tail += count;
+}
+
+/**
+ * @brief Ring position of an element index (e.g. for alignment checks)
+ */
+static __force_inline uint32_t spsc_ring_index(const spsc_ring_t *ring, uint32_t index) {
+    return index & ring->mask;
+}
+
+/**
+ * @brief Total elements dropped by the producer since init
+ */
+static __force_inline uint32_t spsc_ring_overruns(const spsc_ring_t *ring) {
+    return ring->overruns;
+}
+
+#endif // SPSC_RING_H
@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""
+Decoder/recorder for the binary spectrum stream (utils/spectrum_stream.h)
+
+Starts the stream on the Pico, then decodes packets from the USB serial
+port (or from a raw capture file) and writes CSV. With --udp it instead
+collects Wi-Fi telemetry (net/udp_telemetry.h) from any number of
+analyzers, one CSV row per frame prefixed with the sender's address:
+
+  python3 scripts/stream_decoder.py --mode bands8 --csv bands.csv
+  python3 scripts/stream_decoder.py --mode bins --csv bands.csv --bins-csv bins.csv
+  python3 scripts/stream_decoder.py --raw capture.bin        # record only
+  python3 scripts/stream_decoder.py --file capture.bin --csv bands.csv
+  python3 scripts/stream_decoder.py --udp 5077 --group 239.255.77.77 --csv room.csv
+
+Console text between packets is skipped; packets that fail the CRC are
+counted and resynchronized on the next sync bytes.
+"""
+import argparse
+import csv
+import glob
+import socket
+import struct
+import sys
+import time
+
+SYNC = b'\xA5\x5A'
+HEADER = struct.Struct('<2sBBHH')   # sync, type, records, sequence, payload bytes
+MAX_PAYLOAD = 4096
+
+TYPE_BANDS8 = 1
+TYPE_BANDS16 = 2
+TYPE_BINS16 = 3
+
+# Serial command that selects each mode
+MODES = {'bands8': 'b', 'bands16': 'w', 'bins': 'n'}
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)"""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def parse_records(ptype, records, payload):
+    """Yield (kind, timestamp_us, sample_rate, values) per record"""
+    offset = 0
+    for _ in range(records):
+        if ptype in (TYPE_BANDS8, TYPE_BANDS16):
+            timestamp, count = struct.unpack_from('<IB', payload, offset)
+            offset += 5
+            fmt = 'B' if ptype == TYPE_BANDS8 else 'H'
+            scale = 255.0 if ptype == TYPE_BANDS8 else 65535.0
+            values = struct.unpack_from('<%d%s' % (count, fmt), payload, offset)
+            offset += count * struct.calcsize(fmt)
+            yield 'bands', timestamp, None, [v / scale for v in values]
+        elif ptype == TYPE_BINS16:
+            timestamp, rate, count = struct.unpack_from('<IIH', payload, offset)
+            offset += 10
+            values = struct.unpack_from('<%dH' % count, payload, offset)
+            offset += count * 2
+            yield 'bins', timestamp, rate, [v / 65536.0 for v in values]
+
+
+class Decoder:
+    """Incremental packet decoder with resync and loss statistics"""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.packets = 0
+        self.crc_errors = 0
+        self.lost = 0
+        self.last_sequence = None
+
+    def feed(self, data):
+        """Add bytes, yield (packet type, records) for every complete packet"""
+        self.buffer += data
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                # Keep a trailing first sync byte
+                del self.buffer[:max(0, len(self.buffer) - 1)]
+                return
+            del self.buffer[:start]
+            if len(self.buffer) < HEADER.size:
+                return
+
+            _, ptype, records, sequence, length = HEADER.unpack_from(self.buffer)
+            if ptype not in (TYPE_BANDS8, TYPE_BANDS16, TYPE_BINS16) or length > MAX_PAYLOAD:
+                del self.buffer[:1]
+                continue
+            total = HEADER.size + length + 2
+            if len(self.buffer) < total:
+                return
+
+            packet = bytes(self.buffer[:total])
+            (crc,) = struct.unpack_from('<H', packet, total - 2)
+            if crc16(packet[2:total - 2]) != crc:
+                self.crc_errors += 1
+                del self.buffer[:1]
+                continue
+            del self.buffer[:total]
+
+            if self.last_sequence is not None:
+                self.lost += (sequence - self.last_sequence - 1) & 0xFFFF
+            self.last_sequence = sequence
+            self.packets += 1
+            yield ptype, list(parse_records(ptype, records, packet[HEADER.size:total - 2]))
+
+
+def find_pico_port():
+    """Find the Pico's serial port"""
+    for pattern in ('/dev/tty.usbmodem*', '/dev/ttyACM*'):
+        ports = glob.glob(pattern)
+        if ports:
+            return ports[0]
+    return None
+
+
+def receive_udp(args, bands_out):
+    """Collect telemetry datagrams from all analyzers until interrupted"""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(('', args.udp))
+    if args.group:
+        membership = struct.pack('4s4s', socket.inet_aton(args.group), socket.inet_aton('0.0.0.0'))
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, membership)
+    sock.settimeout(1.0)
+    print(f"Listening on UDP port {args.udp}" + (f", group {args.group}" if args.group else ""))
+
+    decoders = {}
+    frames = {}
+    start = time.time()
+    try:
+        while args.seconds is None or time.time() - start < args.seconds:
+            try:
+                data, (source, _) = sock.recvfrom(2048)
+            except socket.timeout:
+                continue
+            decoder = decoders.setdefault(source, Decoder())
+            for _, records in decoder.feed(data):
+                for kind, timestamp, _, values in records:
+                    frames[source] = frames.get(source, 0) + 1
+                    if bands_out:
+                        bands_out.writerow([source, timestamp] + ['%.5f' % v for v in values])
+    except KeyboardInterrupt:
+        pass
+
+    for source, decoder in sorted(decoders.items()):
+        print(f"{source}: {frames.get(source, 0)} frames in {decoder.packets} datagrams, "
+              f"{decoder.lost} lost, {decoder.crc_errors} CRC errors")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--port', help='serial port (default: first Pico found)')
+    parser.add_argument('--file', help='decode a raw capture instead of the serial port')
+    parser.add_argument('--mode', choices=sorted(MODES), default='bands8',
+                        help='stream mode to request (serial only)')
+    parser.add_argument('--csv', help='write band frames here')
+    parser.add_argument('--bins-csv', help='write magnitude spectra here (mode bins)')
+    parser.add_argument('--raw', help='also record the raw byte stream here')
+    parser.add_argument('--udp', type=int, metavar='PORT', help='receive Wi-Fi telemetry instead')
+    parser.add_argument('--group', help='multicast group to join (with --udp)')
+    parser.add_argument('--seconds', type=float, help='stop after this long')
+    args = parser.parse_args()
+
+    bands_out = csv.writer(open(args.csv, 'w', newline='')) if args.csv else None
+    bins_out = csv.writer(open(args.bins_csv, 'w', newline='')) if args.bins_csv else None
+    raw_out = open(args.raw, 'wb') if args.raw else None
+    if args.udp:
+        receive_udp(args, bands_out)
+        return
+
+    ser = None
+    if args.file:
+        source = open(args.file, 'rb')
+    else:
+        import serial
+        port = args.port or find_pico_port()
+        if not port:
+            print("Error: Pico serial port not found")
+            sys.exit(1)
+        ser = serial.Serial(port, 115200, timeout=0.1)
+        ser.write(MODES[args.mode].encode())
+        source = ser
+        print(f"Streaming {args.mode} from {port}, Ctrl+C to stop")
+
+    decoder = Decoder()
+    frames = 0
+    start = time.time()
+    last_report = start
+    try:
+        while args.seconds is None or time.time() - start < args.seconds:
+            data = source.read(4096)
+            if not data:
+                if args.file:
+                    break
+                continue
+            if raw_out:
+                raw_out.write(data)
+
+            for _, records in decoder.feed(data):
+                for kind, timestamp, rate, values in records:
+                    if kind == 'bands':
+                        frames += 1
+                        if bands_out:
+                            bands_out.writerow([timestamp] + ['%.5f' % v for v in values])
+                    elif bins_out:
+                        bins_out.writerow([timestamp, rate] + ['%.6f' % v for v in values])
+
+            now = time.time()
+            if not args.file and now - last_report >= 1.0:
+                print(f"{frames / (now - start):6.1f} frames/s | packets {decoder.packets} "
+                      f"| lost {decoder.lost} | CRC errors {decoder.crc_errors}")
+                last_report = now
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if ser:
+            ser.write(b'x')
+            ser.close()
+
+    print(f"\n{frames} band frames in {decoder.packets} packets, "
+          f"{decoder.lost} packets lost, {decoder.crc_errors} CRC errors")
+
+
+if __name__ == "__main__":
+    main()
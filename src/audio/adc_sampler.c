@@ -2,75 +2,283 @@
  * @file adc_sampler.c
  * @brief ADC audio sampling implementation
  * 
- * Uses free-running ADC with DMA for efficient sample capture.
- * Timer triggers ADC conversions at precise intervals.
+ * Conversions are paced in hardware, in one of two ways:
+ * 
+ * - ADC_PIO_PACING: a PIO state machine ticks once per sample period,
+ *   counted in whole system clock cycles, and a DMA channel turns every
+ *   tick into an ADC START_ONCE (pio/adc_sampler.pio)
+ * - Otherwise the ADC free-runs on its own clock divider
+ * 
+ * Either way every conversion lands in the ADC FIFO, and two chained DMA
+ * channels drain it in ping-pong fashion, each filling one block of the
+ * ring buffer, so the CPU only takes one interrupt per completed block.
+ * No sample instant depends on interrupt latency.
  */
 
 #include "audio/adc_sampler.h"
+#include "utils/spsc_ring.h"
 #include "hardware/adc.h"
 #include "hardware/dma.h"
-#include "hardware/timer.h"
 #include "hardware/irq.h"
+#include "hardware/sync.h"
 #include "config.h"
+#if ADC_PIO_PACING
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "adc_sampler.pio.h"
+#endif
 #include <string.h>
 
 // ============================================================================
 // Configuration
 // ============================================================================
 
-#define BUFFER_SIZE 1024  // Must be power of 2
+#define BUFFER_SIZE 2048  // Must be power of 2 (two hops at FFT_SIZE_MAX)
 #define BUFFER_MASK (BUFFER_SIZE - 1)
 
+#define BLOCK_SIZE  ADC_DMA_BLOCK_SIZE
+#define BLOCK_BYTES (BLOCK_SIZE * sizeof(uint16_t))
+#define BLOCK_BYTES_LOG2 (__builtin_ctz(BLOCK_BYTES))
+
+#define ADC_CLOCK_HZ 48000000.0f  // ADC is clocked from the 48 MHz USB PLL
+#define ADC_MAX_RATE_HZ 500000    // One conversion takes 96 ADC clocks
+
+#define PACER_PIO pio0
+#define PACER_TRIGGER_COUNT 0xFFFFFFFFu  // Ticks per trigger DMA run (restarted by the IRQ)
+
+_Static_assert((BUFFER_SIZE & BUFFER_MASK) == 0, "BUFFER_SIZE must be a power of 2");
+_Static_assert((BLOCK_SIZE & (BLOCK_SIZE - 1)) == 0, "ADC_DMA_BLOCK_SIZE must be a power of 2");
+_Static_assert(BUFFER_SIZE % BLOCK_SIZE == 0 && BUFFER_SIZE >= 4 * BLOCK_SIZE,
+               "BUFFER_SIZE must hold at least four DMA blocks");
+_Static_assert(BUFFER_SIZE / 2 >= FFT_HOP_FOR(FFT_SIZE_MAX),
+               "BUFFER_SIZE must allow acquiring a hop at FFT_SIZE_MAX");
+
 // ============================================================================
 // Private State
 // ============================================================================
 
-static uint16_t _sample_buffer[BUFFER_SIZE];
-static volatile uint32_t _write_pos = 0;
-static volatile uint32_t _read_pos = 0;
+// Blocks are aligned to their own size so the DMA write ring can wrap
+// inside a block (a late IRQ then corrupts one block, never other memory)
+static uint16_t _sample_buffer[BUFFER_SIZE] __attribute__((aligned(BLOCK_BYTES)));
+static uint16_t _discard_block[BLOCK_SIZE] __attribute__((aligned(BLOCK_BYTES)));
+
+// The DMA IRQ is the producer (head), the reader the consumer (tail)
+static spsc_ring_t _ring;
+static uint32_t _in_flight = 0;              // Samples past the head handed to DMA
+static uint32_t _acquired = 0;               // Size of the block held by the reader
+
+// Not const: the IRQ handler reads these, and must not touch flash
+// (it keeps running while the sample source writes to flash)
+static uint _dma_channels[2] = {DMA_CHANNEL_ADC_PING, DMA_CHANNEL_ADC_PONG};
+static bool _dma_discard[2];                 // Channel captures into _discard_block
+static uint8_t _dma_next_done = 0;           // Channel expected to complete next
+
 static uint32_t _sample_rate_hz = 0;
 static uint8_t _adc_channel = 0;
-static int _dma_channel = -1;
-static struct repeating_timer _sample_timer;
+static bool _dma_ready = false;
 static volatile bool _is_running = false;
 
+#if ADC_PIO_PACING
+static uint _pacer_sm = 0;
+static uint _pacer_offset = 0;
+static uint32_t _pacer_period = 0;           // System clock cycles per sample
+static bool _pacer_ready = false;
+#endif
+
 // ============================================================================
 // Private Functions
 // ============================================================================
 
+#if ADC_PIO_PACING
 /**
- * @brief Timer callback to trigger ADC conversion
+ * @brief PIO sample clock period for a sample rate
+ * @return System clock cycles per sample, or 0 if the rate cannot be paced
  */
-static bool sample_timer_callback(struct repeating_timer *t) {
-    if (!_is_running) return true;
+static uint32_t rate_to_period(uint32_t sample_rate_hz) {
+    if (sample_rate_hz == 0 || sample_rate_hz > ADC_MAX_RATE_HZ) return 0;
     
-    // Trigger ADC conversion
-    adc_select_input(_adc_channel);
-    adc_run(true);
+    // Rounded to whole cycles: under 0.02% rate error at 48 kHz and 125 MHz
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    return (sys_hz + sample_rate_hz / 2) / sample_rate_hz;
+}
+#else
+/**
+ * @brief ADC clock divider for a sample rate
+ * @return Divider, or a negative value if the rate cannot be paced
+ */
+static float rate_to_clkdiv(uint32_t sample_rate_hz) {
+    if (sample_rate_hz == 0 || sample_rate_hz > ADC_MAX_RATE_HZ) return -1.0f;
     
-    // Read result (12-bit ADC)
-    uint16_t sample = adc_fifo_get_blocking();
+    // Clock divider is 16 bits; slower rates cannot be paced by the ADC
+    float clkdiv = ADC_CLOCK_HZ / sample_rate_hz - 1.0f;
+    return (clkdiv > 65535.0f) ? -1.0f : clkdiv;
+}
+#endif
+
+/**
+ * @brief Check that the active pacing method can produce a rate
+ */
+static bool rate_is_supported(uint32_t sample_rate_hz) {
+#if ADC_PIO_PACING
+    return rate_to_period(sample_rate_hz) > adc_pacer_OVERHEAD_CYCLES;
+#else
+    return rate_to_clkdiv(sample_rate_hz) >= 0.0f;
+#endif
+}
+
+/**
+ * @brief Program the sample clock for a supported rate (capture stopped)
+ */
+static void set_pacing(uint32_t sample_rate_hz) {
+#if ADC_PIO_PACING
+    // Loaded into the state machine by adc_sampler_start()
+    _pacer_period = rate_to_period(sample_rate_hz);
+#else
+    adc_set_clkdiv(rate_to_clkdiv(sample_rate_hz));
+#endif
+}
+
+/**
+ * @brief Abort a DMA channel without leaving a spurious completion behind
+ */
+static void abort_channel(uint ch) {
+    // Disable IRQs before aborting (abort can raise a spurious completion)
+    dma_channel_set_irq0_enabled(ch, false);
+    dma_channel_abort(ch);
+    dma_channel_acknowledge_irq0(ch);
+    dma_channel_set_irq0_enabled(ch, true);
+}
+
+/**
+ * @brief Point a capture channel at the next free ring block
+ * 
+ * If the reader has not freed a block yet the channel captures into a
+ * scratch block instead, and the samples are counted as an overrun.
+ */
+static void __not_in_flash_func(arm_channel)(uint8_t index) {
+    uint16_t *dest;
+    
+    // Blocks are filled in place and committed in capture order
+    if (spsc_ring_free(&_ring) >= _in_flight + BLOCK_SIZE) {
+        _dma_discard[index] = false;
+        dest = spsc_ring_write_ptr(&_ring, _in_flight);
+        _in_flight += BLOCK_SIZE;
+    } else {
+        _dma_discard[index] = true;
+        dest = _discard_block;
+    }
     
-    // Store in circular buffer
-    _sample_buffer[_write_pos] = sample;
-    _write_pos = (_write_pos + 1) & BUFFER_MASK;
+    // Transfer count reloads on every trigger, only the address needs resetting
+    // (register write rather than the SDK inline, which may live in flash)
+    dma_hw->ch[_dma_channels[index]].write_addr = (uintptr_t)dest;
+}
+
+/**
+ * @brief DMA completion handler, runs once per captured block
+ */
+static void __not_in_flash_func(dma_irq_handler)(void) {
+#if ADC_PIO_PACING
+    // Trigger channel runs out after 2^32 - 1 samples (a day at 48 kHz)
+    if (dma_hw->ints0 & (1u << DMA_CHANNEL_ADC_TRIGGER)) {
+        dma_hw->ints0 = 1u << DMA_CHANNEL_ADC_TRIGGER;
+        if (_is_running) {
+            dma_hw->multi_channel_trigger = 1u << DMA_CHANNEL_ADC_TRIGGER;
+        }
+    }
+#endif
     
-    // Check for buffer overflow
-    if (_write_pos == _read_pos) {
-        // Buffer full, drop oldest sample
-        _read_pos = (_read_pos + 1) & BUFFER_MASK;
+    // Completions strictly alternate, so service them in capture order
+    while (dma_hw->ints0 & (1u << _dma_channels[_dma_next_done])) {
+        uint8_t index = _dma_next_done;
+        dma_hw->ints0 = 1u << _dma_channels[index];
+        
+        if (!_dma_discard[index]) {
+            _in_flight -= BLOCK_SIZE;
+            spsc_ring_commit(&_ring, BLOCK_SIZE);
+        } else {
+            spsc_ring_add_overruns(&_ring, BLOCK_SIZE);
+        }
+        
+        // The partner channel is already running; queue this one behind it
+        arm_channel(index);
+        _dma_next_done ^= 1;
     }
+}
+
+/**
+ * @brief Configure both capture channels, chained to each other
+ */
+static void setup_dma(void) {
+    for (uint8_t i = 0; i < 2; i++) {
+        uint ch = _dma_channels[i];
+        dma_channel_claim(ch);
+        
+        dma_channel_config c = dma_channel_get_default_config(ch);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_ring(&c, true, BLOCK_BYTES_LOG2);
+        channel_config_set_dreq(&c, DREQ_ADC);
+        channel_config_set_chain_to(&c, _dma_channels[i ^ 1]);
+        
+        dma_channel_configure(ch, &c, _discard_block, &adc_hw->fifo, BLOCK_SIZE, false);
+        dma_channel_set_irq0_enabled(ch, true);
+    }
+    
+    irq_add_shared_handler(DMA_IRQ_0, dma_irq_handler,
+                           PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
     
-    return true;  // Continue timer
+    _dma_ready = true;
 }
 
+#if ADC_PIO_PACING
+/**
+ * @brief Load the sample clock program and its trigger DMA channel
+ */
+static bool setup_pacer(void) {
+    if (!pio_can_add_program(PACER_PIO, &adc_pacer_program)) return false;
+    
+    int sm = pio_claim_unused_sm(PACER_PIO, false);
+    if (sm < 0) return false;
+    
+    _pacer_sm = (uint)sm;
+    _pacer_offset = pio_add_program(PACER_PIO, &adc_pacer_program);
+    
+    // Every tick moves one word from the RX FIFO to the CS set alias, which
+    // sets START_ONCE and leaves the rest of CS alone
+    uint ch = DMA_CHANNEL_ADC_TRIGGER;
+    dma_channel_claim(ch);
+    
+    dma_channel_config c = dma_channel_get_default_config(ch);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(PACER_PIO, _pacer_sm, false));
+    channel_config_set_high_priority(&c, true);  // Don't queue behind display transfers
+    
+    dma_channel_configure(ch, &c, &hw_set_alias(adc_hw)->cs, &PACER_PIO->rxf[_pacer_sm],
+                          PACER_TRIGGER_COUNT, false);
+    dma_channel_set_irq0_enabled(ch, true);
+    
+    _pacer_ready = true;
+    return true;
+}
+#endif
+
 // ============================================================================
 // Public API
 // ============================================================================
 
 bool adc_sampler_init(uint8_t adc_channel, uint32_t sample_rate_hz) {
-    if (adc_channel > 3) return false;
-    if (sample_rate_hz == 0 || sample_rate_hz > 500000) return false;
+    if (adc_channel > 3 || !rate_is_supported(sample_rate_hz)) return false;
+
+#if ADC_PIO_PACING
+    if (!_pacer_ready && !setup_pacer()) {
+        DEBUG_PRINTF("ADC sampler: no free PIO state machine for the sample clock\n");
+        return false;
+    }
+#endif
     
     _adc_channel = adc_channel;
     _sample_rate_hz = sample_rate_hz;
@@ -88,33 +296,60 @@ bool adc_sampler_init(uint8_t adc_channel, uint32_t sample_rate_hz) {
     // Set up ADC FIFO
     adc_fifo_setup(
         true,    // Enable FIFO
-        false,   // No DMA
-        1,       // Trigger threshold
+        true,    // Assert DREQ for DMA
+        1,       // DREQ on every sample
         false,   // No error bit
         false    // No byte shifting
     );
     
+    // Conversion rate (free-running divider or PIO sample clock)
+    set_pacing(sample_rate_hz);
+    
+    if (!_dma_ready) {
+        setup_dma();
+    }
+    
     // Clear buffer
     memset(_sample_buffer, 0, sizeof(_sample_buffer));
-    _write_pos = 0;
-    _read_pos = 0;
+    spsc_ring_init(&_ring, _sample_buffer, sizeof(uint16_t), BUFFER_SIZE);
+    _in_flight = 0;
+    _acquired = 0;
     _is_running = false;
     
-    DEBUG_PRINTF("ADC sampler initialized: CH%d @ %lu Hz\n", adc_channel, sample_rate_hz);
+    DEBUG_PRINTF("ADC sampler initialized: CH%d @ %lu Hz (%s, DMA, %d-sample blocks)\n",
+                 adc_channel, sample_rate_hz, ADC_PIO_PACING ? "PIO clock" : "ADC divider",
+                 BLOCK_SIZE);
     
     return true;
 }
 
 void adc_sampler_start(void) {
-    if (_is_running) return;
+    if (_is_running || !_dma_ready) return;
     
-    _is_running = true;
+    // Start from an empty ring and a drained FIFO. The reset restarts at
+    // position 0, keeping the read position aligned for any acquire size.
+    spsc_ring_reset(&_ring);
+    _in_flight = 0;
+    _dma_next_done = 0;
+    adc_fifo_drain();
     
-    // Calculate timer interval in microseconds
-    int64_t interval_us = 1000000LL / _sample_rate_hz;
+    arm_channel(0);
+    arm_channel(1);
     
-    // Start repeating timer
-    add_repeating_timer_us(-interval_us, sample_timer_callback, NULL, &_sample_timer);
+    _is_running = true;
+    
+    // PING waits on DREQ; PONG is triggered by the chain when PING completes
+    dma_channel_start(_dma_channels[0]);
+
+#if ADC_PIO_PACING
+    // Fresh state machine and FIFOs, then every tick starts one conversion
+    adc_pacer_program_init(PACER_PIO, _pacer_sm, _pacer_offset, _pacer_period,
+                           ADC_CS_START_ONCE_BITS);
+    dma_channel_start(DMA_CHANNEL_ADC_TRIGGER);
+    pio_sm_set_enabled(PACER_PIO, _pacer_sm, true);
+#else
+    adc_run(true);
+#endif
     
     DEBUG_PRINTF("ADC sampler started\n");
 }
@@ -123,38 +358,77 @@ void adc_sampler_stop(void) {
     if (!_is_running) return;
     
     _is_running = false;
-    cancel_repeating_timer(&_sample_timer);
+
+#if ADC_PIO_PACING
+    pio_sm_set_enabled(PACER_PIO, _pacer_sm, false);
+    abort_channel(DMA_CHANNEL_ADC_TRIGGER);
+#else
     adc_run(false);
+#endif
+    
+    for (uint8_t i = 0; i < 2; i++) {
+        abort_channel(_dma_channels[i]);
+    }
+    
+    // Waits for a conversion still in flight
+    adc_fifo_drain();
     
     DEBUG_PRINTF("ADC sampler stopped\n");
 }
 
-uint32_t adc_sampler_available(void) {
-    uint32_t write = _write_pos;
-    uint32_t read = _read_pos;
+bool adc_sampler_set_rate(uint32_t sample_rate_hz) {
+    if (_acquired || !rate_is_supported(sample_rate_hz)) return false;
     
-    if (write >= read) {
-        return write - read;
-    } else {
-        return BUFFER_SIZE - read + write;
+    // Samples already in the ring belong to the old rate; drop them
+    bool was_running = _is_running;
+    adc_sampler_stop();
+    
+    set_pacing(sample_rate_hz);
+    _sample_rate_hz = sample_rate_hz;
+    
+    DEBUG_PRINTF("ADC sample rate set to %lu Hz\n", sample_rate_hz);
+    
+    if (was_running) {
+        adc_sampler_start();
     }
+    return true;
+}
+
+uint32_t adc_sampler_available(void) {
+    return spsc_ring_available(&_ring);
 }
 
 uint32_t adc_sampler_read(uint16_t *buffer, uint32_t count) {
-    if (!buffer || count == 0) return 0;
+    if (!buffer || count == 0 || _acquired) return 0;
     
-    uint32_t available = adc_sampler_available();
-    uint32_t to_read = (count < available) ? count : available;
+    return spsc_ring_pop(&_ring, buffer, count);
+}
+
+const uint16_t *adc_sampler_acquire_block(uint32_t count) {
+    if (_acquired || count == 0 || count > BUFFER_SIZE / 2) return NULL;
+    if (count & (count - 1)) return NULL;
     
-    for (uint32_t i = 0; i < to_read; i++) {
-        buffer[i] = _sample_buffer[_read_pos];
-        _read_pos = (_read_pos + 1) & BUFFER_MASK;
-    }
+    // Misaligned by a previous read()
+    if (spsc_ring_index(&_ring, _ring.tail) & (count - 1)) return NULL;
+    if (spsc_ring_available(&_ring) < count) return NULL;
     
-    return to_read;
+    // Aligned power-of-2 blocks never straddle the end of the ring
+    _acquired = count;
+    return spsc_ring_read_ptr(&_ring);
+}
+
+void adc_sampler_release_block(void) {
+    if (!_acquired) return;
+    
+    // Reader is done with the block before the DMA may reuse it
+    spsc_ring_release(&_ring, _acquired);
+    _acquired = 0;
+}
+
+uint32_t adc_sampler_get_overruns(void) {
+    return spsc_ring_overruns(&_ring);
 }
 
 uint32_t adc_sampler_get_rate(void) {
     return _sample_rate_hz;
 }
-
@@ -0,0 +1,186 @@
+/**
+ * @file band_dynamics.c
+ * @brief Band dynamics implementation
+ * 
+ * State is kept in Q8.16 palette levels (full scale 255 << 16), eight bits
+ * finer than the published Q8.8, so the small per-hop steps of slow time
+ * constants at high FFT rates are not rounded away. A follower step is
+ * ((target - level) >> 8) * k >> 7 with k = (1 - retention per frame) in
+ * Q15, which fits 32 bits for any full-scale difference.
+ * 
+ * Only band_dynamics_configure() uses floating point (powf/expf, once per
+ * settings change).
+ */
+
+#include "audio/band_dynamics.h"
+#include "config.h"
+#include <math.h>
+#include <string.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define LEVEL_FULL      (255u << 16)    // Q8.16 level of a 1.0 amplitude
+#define LEVEL_FLOOR     (653u << 8)     // ~0.01 of full scale, snaps to zero
+#define COEF_ONE        32768u          // Q15 step coefficient for "follow at once"
+#define GAIN_ONE        256u            // Q8.8 unity gain
+
+#define AGC_TARGET      ((uint32_t)(AGC_TARGET_LEVEL * LEVEL_FULL))
+#define AGC_GAIN_MAX    ((uint32_t)(AGC_MAX_GAIN * GAIN_ONE))
+#define AGC_ENV_MIN     ((uint32_t)(AGC_TARGET_LEVEL * LEVEL_FULL / AGC_MAX_GAIN))  // Envelope at maximum gain
+
+_Static_assert(AGC_MAX_GAIN >= 1.0f && AGC_MAX_GAIN <= 64.0f, "AGC_MAX_GAIN must be 1 to 64");
+_Static_assert(AGC_TARGET_LEVEL > 0.0f && AGC_TARGET_LEVEL <= 1.0f,
+               "AGC_TARGET_LEVEL must be in (0, 1]");
+
+// ============================================================================
+// Private State (audio core only)
+// ============================================================================
+
+static uint32_t _levels[BAND_COUNT_MAX];        // Smoothed, Q8.16
+static uint32_t _peaks[BAND_COUNT_MAX];         // Peak hold, Q8.16
+static uint16_t _peak_hold[BAND_COUNT_MAX];     // Band frames left before the peak decays
+
+// Per-frame step coefficients (Q15) and hold length for the current interval
+static uint32_t _k_rise = COEF_ONE;
+static uint32_t _k_fall = COEF_ONE;
+static uint32_t _k_peak = COEF_ONE;
+static uint32_t _k_agc = COEF_ONE;
+static uint16_t _hold_frames = 0;
+
+static uint32_t _agc_envelope = AGC_TARGET;     // Loudest-band envelope, Q8.16
+static volatile uint32_t _gain = GAIN_ONE;      // Q8.8, read by the display core for stats
+
+// ============================================================================
+// Private Functions
+// ============================================================================
+
+/**
+ * @brief Q15 step coefficient for a retention factor per display frame
+ * @param frames Band frame interval in display frames
+ */
+static uint32_t step_coefficient(float retention, float frames) {
+    if (retention <= 0.0f) return COEF_ONE;
+    if (retention >= 1.0f) return 0;
+    
+    uint32_t k = (uint32_t)((1.0f - powf(retention, frames)) * COEF_ONE + 0.5f);
+    return (k < 1) ? 1 : (k > COEF_ONE) ? COEF_ONE : k;
+}
+
+/**
+ * @brief Move a Q8.16 level one band frame towards a target
+ */
+static inline uint32_t follow(uint32_t level, uint32_t target, uint32_t k) {
+    if (target > level) {
+        return level + ((((target - level) >> 8) * k) >> 7);
+    }
+    return level - ((((level - target) >> 8) * k) >> 7);
+}
+
+#if AUTO_GAIN_ENABLED
+/**
+ * @brief Update the AGC envelope from this frame's loudest band and derive the gain
+ */
+static uint32_t update_gain(uint32_t loudest) {
+    // Instant attack, exponential release, never below the maximum-gain point
+    if (loudest >= _agc_envelope) {
+        _agc_envelope = loudest;
+    } else {
+        _agc_envelope = follow(_agc_envelope, loudest, _k_agc);
+    }
+    if (_agc_envelope < AGC_ENV_MIN) _agc_envelope = AGC_ENV_MIN;
+    
+    // 256 * target / envelope, both sides scaled to stay within 32 bits
+    uint32_t gain = (AGC_TARGET << 4) / (_agc_envelope >> 4);
+    if (gain < GAIN_ONE) gain = GAIN_ONE;
+    if (gain > AGC_GAIN_MAX) gain = AGC_GAIN_MAX;
+    return gain;
+}
+#endif
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void band_dynamics_init(void) {
+    memset(_levels, 0, sizeof(_levels));
+    memset(_peaks, 0, sizeof(_peaks));
+    memset(_peak_hold, 0, sizeof(_peak_hold));
+    _agc_envelope = AGC_TARGET;
+    _gain = GAIN_ONE;
+    band_dynamics_configure(FFT_HOP_SIZE, SAMPLE_RATE_HZ);
+}
+
+bool band_dynamics_configure(uint32_t hop_size, uint32_t sample_rate_hz) {
+    if (hop_size == 0 || sample_rate_hz == 0) return false;
+    
+    float interval_us = hop_size * 1000000.0f / sample_rate_hz;
+    float frames = interval_us / FRAME_TIME_US;
+    
+    _k_rise = step_coefficient(SMOOTHING_FACTOR, frames);
+    _k_fall = step_coefficient(SMOOTHING_RELEASE, frames);
+    _k_peak = step_coefficient(PEAK_DECAY_RATE, frames);
+    _k_agc = step_coefficient(expf(-(float)FRAME_TIME_US / (AGC_RELEASE_MS * 1000.0f)), frames);
+    
+    float hold = ceilf(PEAK_HOLD_MS * 1000.0f / interval_us);
+    _hold_frames = (hold > UINT16_MAX) ? UINT16_MAX : (uint16_t)hold;
+    
+    DEBUG_PRINTF("Band dynamics: %.2f ms per frame, k rise/fall/peak %lu/%lu/%lu, hold %u\n",
+                 interval_us / 1000.0f, _k_rise, _k_fall, _k_peak, _hold_frames);
+    return true;
+}
+
+void band_dynamics_process(const float *bands, uint8_t num_bands,
+                           uint16_t *levels, uint16_t *peaks) {
+    if (!bands || !levels || !peaks || num_bands == 0 || num_bands > BAND_COUNT_MAX) return;
+    
+    // Amplitudes to Q8.16 once; the rest is integer
+    uint32_t input[BAND_COUNT_MAX];
+    uint32_t loudest = 0;
+    for (uint8_t i = 0; i < num_bands; i++) {
+        float a = bands[i];
+        input[i] = (a <= 0.0f) ? 0 : (a >= 1.0f) ? LEVEL_FULL : (uint32_t)(a * LEVEL_FULL);
+        if (input[i] > loudest) loudest = input[i];
+    }
+
+#if AUTO_GAIN_ENABLED
+    uint32_t gain = update_gain(loudest);
+    _gain = gain;
+#else
+    (void)loudest;
+#endif
+    
+    for (uint8_t i = 0; i < num_bands; i++) {
+        uint32_t target = input[i];
+#if AUTO_GAIN_ENABLED
+        target = (target >> 8) * gain;
+        if (target > LEVEL_FULL) target = LEVEL_FULL;
+#endif
+        
+        // Fast rise, slower fall
+        uint32_t level = follow(_levels[i], target, (target > _levels[i]) ? _k_rise : _k_fall);
+        if (level < LEVEL_FLOOR) level = 0;
+        _levels[i] = level;
+        
+        // Peak follows the smoothed level up, holds, then decays
+        uint32_t peak = _peaks[i];
+        if (level >= peak) {
+            peak = level;
+            _peak_hold[i] = _hold_frames;
+        } else if (_peak_hold[i] > 0) {
+            _peak_hold[i]--;
+        } else {
+            peak = follow(peak, 0, _k_peak);
+            if (peak < LEVEL_FLOOR) peak = 0;
+        }
+        _peaks[i] = peak;
+        
+        levels[i] = (uint16_t)(level >> 8);
+        peaks[i] = (uint16_t)(peak >> 8);
+    }
+}
+
+uint32_t band_dynamics_gain(void) {
+    return _gain;
+}
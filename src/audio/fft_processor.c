@@ -2,11 +2,37 @@
  * @file fft_processor.c
  * @brief FFT processing implementation
  * 
- * Uses a simple real FFT implementation optimized for Cortex-M0+.
- * Extracts frequency bands from FFT output for visualization.
+ * Uses a packed real FFT (N/2-point complex FFT plus split step) with
+ * twiddle and bit-reversal tables. The FFT size and sample rate can be
+ * changed at run time: every buffer and table is carved for the active
+ * size out of one static arena sized for FFT_SIZE_MAX, and rebuilt by
+ * fft_processor_configure(). Extracts frequency bands from FFT output for
+ * visualization.
+ * 
+ * With multirate analysis each band is owned by one level: the lowest
+ * sample rate (fs / 2^level, see audio/multirate.h) that still covers its
+ * upper edge. An FFT at a level refreshes only its own bands; the others
+ * keep their last value until their level runs again.
+ * 
+ * Two arithmetic back ends, chosen with FFT_FIXED_POINT in config.h:
+ * - Fixed point: Q15 samples/twiddles, int32 butterflies scaled by 1/2 per
+ *   stage, alpha-max-plus-beta-min magnitude.
+ *   No soft-float in the per-sample or per-bin path.
+ * - Floating point: reference implementation (soft-float on the RP2040).
+ * 
+ * Both share a band plan (bin ranges and gains per band, rebuilt only when
+ * the band count or sample rate changes) and table-based log compression.
+ * Levels are normalized to an FFT_LEVEL_REFERENCE_SIZE-point transform, so
+ * a tone reads the same at every run-time size.
+ * 
+ * The first two butterfly stages have trivial twiddles and run as one
+ * multiply-free pass. Building with FFT_SIZE_FIXED (CMake SPECTRUM_FFT_SIZE)
+ * drops run-time sizing in favour of kernels specialized for FFT_SIZE,
+ * with an arena sized for just that size.
  */
 
 #include "audio/fft_processor.h"
+#include "utils/profiler.h"
 #include "config.h"
 #include <math.h>
 #include <string.h>
@@ -18,92 +44,462 @@
 #define PI 3.14159265358979323846f
 #define TWO_PI (2.0f * PI)
 
+_Static_assert(FFT_SIZE >= FFT_SIZE_MIN && FFT_SIZE <= FFT_SIZE_MAX &&
+               (FFT_SIZE & (FFT_SIZE - 1)) == 0, "FFT_SIZE must be a power of 2 in range");
+_Static_assert((FFT_SIZE_MAX & (FFT_SIZE_MAX - 1)) == 0, "FFT_SIZE_MAX must be a power of 2");
+_Static_assert(FFT_SIZE_MIN >= 8, "The fused first stages need N/2 >= 4");
+
+// Active size for the kernels. With FFT_SIZE_FIXED they are compile-time
+// constants, so loop bounds, strides and the stage count fold away.
+#if FFT_SIZE_FIXED
+#define FFT_N       FFT_SIZE
+#define FFT_HALF_N  (FFT_SIZE / 2)
+#else
+#define FFT_N       _fft_size
+#define FFT_HALF_N  _fft_half
+#endif
+
+#if FFT_FIXED_POINT
+typedef int32_t fft_work_t;     // Q15 values with headroom for butterflies
+typedef uint32_t fft_mag_t;     // Magnitude in units of 2^-15 * N/2
+
+#define Q15_ONE 32767
+
+// Alpha-max-plus-beta-min coefficients (max error ~4%), Q15
+#define MAG_ALPHA_Q15 31470     // 0.96043
+#define MAG_BETA_Q15  13036     // 0.39782
+#else
+typedef float fft_work_t;
+typedef float fft_mag_t;
+#endif
+
+// log(1 + 10x) / log(11) for x in [0, 1], with linear interpolation
+#define LOG_LUT_BITS 8
+#define LOG_LUT_SIZE (1 << LOG_LUT_BITS)
+#define LEVEL_Q16_ONE 65536u
+
+/**
+ * @brief Precomputed extraction parameters for one band
+ */
+typedef struct {
+    uint16_t bin_start;     // First FFT bin in the band
+    uint16_t bin_end;       // One past the last bin
+    uint8_t level;          // Analysis level that measures it (rate fs / 2^level)
+#if FFT_FIXED_POINT
+    uint32_t weight;        // Magnitude sum -> Q16 linear level, Q16 factor
+#else
+    float weight;           // Magnitude sum -> linear level (1 / (count * gain))
+#endif
+} band_plan_entry_t;
+
+// Everything sized by N, for the largest N (the real FFT works on N/2 points)
+#define ARENA_BYTES (FFT_SIZE_MAX * sizeof(fft_work_t) +            /* window */     \
+                     4 * (FFT_SIZE_MAX / 2) * sizeof(fft_work_t) +  /* re, im, twiddles */ \
+                     (FFT_SIZE_MAX / 2) * sizeof(fft_mag_t) +       /* magnitudes */ \
+                     (FFT_SIZE_MAX / 2) * sizeof(uint16_t))         /* bit reversal */
+
 // ============================================================================
 // Private State
 // ============================================================================
 
 static uint32_t _sample_rate_hz = 0;
-static float _fft_input[FFT_SIZE];
-static float _fft_output[FFT_SIZE];
-static float _window[FFT_SIZE];
+static uint32_t _fft_size = 0;      // N (0 = not configured)
+static uint32_t _fft_half = 0;      // N / 2, the complex FFT length
+
+// Backing store for the size-dependent buffers below
+static uint32_t _arena[(ARENA_BYTES + 3) / 4];
+static uint32_t _arena_used = 0;    // Bytes handed out for the current size
+
+static fft_work_t *_window;         // Hann window, N entries
+
+// Packed real input / complex spectrum (z[n] = x[2n] + j*x[2n+1]), N/2 each
+static fft_work_t *_fft_real;
+static fft_work_t *_fft_imag;
+
+// Lookup tables rebuilt for every size, N/2 entries each
+static fft_work_t *_twiddle_cos;    // cos(2*pi*k/N)
+static fft_work_t *_twiddle_sin;    // sin(2*pi*k/N)
+static uint16_t *_bit_reverse;      // Bit-reversed index for N/2 points
+
+static fft_mag_t *_magnitudes;      // Magnitude spectrum, N/2 bins
+static bool _magnitudes_valid = false;  // An FFT ran since the last configure
+
+static uint16_t _log_lut[LOG_LUT_SIZE + 1];  // Compressed level, 0..65535
+
+// Band plan for _band_plan_bands bands (0 = not built yet)
+static band_plan_entry_t _band_plan[BAND_COUNT_MAX];
+static uint8_t _band_plan_bands = 0;
+
+static uint8_t _levels = 1;                     // Multirate levels (1 = full rate only)
+static float _held_bands[BAND_COUNT_MAX];       // Latest result of every band
 
 // ============================================================================
-// Simple FFT Implementation
+// Arena
 // ============================================================================
 
 /**
- * @brief Bit-reverse permutation for FFT
+ * @brief Take the next word-aligned piece of the arena
  */
-static uint32_t bit_reverse(uint32_t x, uint32_t bits) {
-    uint32_t result = 0;
-    for (uint32_t i = 0; i < bits; i++) {
-        result = (result << 1) | (x & 1);
-        x >>= 1;
-    }
-    return result;
+static void *arena_alloc(uint32_t bytes) {
+    bytes = (bytes + 3) & ~3u;
+    if (_arena_used + bytes > sizeof(_arena)) return NULL;
+    
+    void *p = (uint8_t *)_arena + _arena_used;
+    _arena_used += bytes;
+    return p;
 }
 
 /**
- * @brief Simple radix-2 FFT implementation
- * 
- * This is a basic FFT for educational purposes and initial testing.
- * For production, consider using CMSIS-DSP or pico-extras FFT.
+ * @brief Lay out all size-dependent buffers for _fft_size
+ */
+static bool allocate_buffers(void) {
+    _arena_used = 0;
+    
+    _window = arena_alloc(_fft_size * sizeof(fft_work_t));
+    _fft_real = arena_alloc(_fft_half * sizeof(fft_work_t));
+    _fft_imag = arena_alloc(_fft_half * sizeof(fft_work_t));
+    _twiddle_cos = arena_alloc(_fft_half * sizeof(fft_work_t));
+    _twiddle_sin = arena_alloc(_fft_half * sizeof(fft_work_t));
+    _magnitudes = arena_alloc(_fft_half * sizeof(fft_mag_t));
+    _bit_reverse = arena_alloc(_fft_half * sizeof(uint16_t));
+    
+    return _bit_reverse != NULL;
+}
+
+// ============================================================================
+// Real FFT Implementation
+// ============================================================================
+
+/**
+ * @brief Build window, twiddle and bit-reversal tables for _fft_size
  */
-static void simple_fft(float *real, float *imag, uint32_t n) {
-    // Bit-reverse permutation
-    uint32_t bits = 0;
-    uint32_t temp = n;
-    while (temp > 1) {
-        bits++;
-        temp >>= 1;
+static void build_tables(void) {
+    // Hann window
+    for (uint32_t i = 0; i < _fft_size; i++) {
+        float w = 0.5f * (1.0f - cosf(TWO_PI * i / (_fft_size - 1)));
+#if FFT_FIXED_POINT
+        _window[i] = (fft_work_t)lroundf(w * Q15_ONE);
+#else
+        _window[i] = w;
+#endif
     }
     
-    for (uint32_t i = 0; i < n; i++) {
-        uint32_t j = bit_reverse(i, bits);
-        if (j > i) {
-            // Swap real parts
-            float temp_r = real[i];
-            real[i] = real[j];
-            real[j] = temp_r;
-            
-            // Swap imaginary parts
-            float temp_i = imag[i];
-            imag[i] = imag[j];
-            imag[j] = temp_i;
+    for (uint32_t k = 0; k < _fft_half; k++) {
+        float angle = TWO_PI * k / _fft_size;
+#if FFT_FIXED_POINT
+        _twiddle_cos[k] = (fft_work_t)lroundf(cosf(angle) * Q15_ONE);
+        _twiddle_sin[k] = (fft_work_t)lroundf(sinf(angle) * Q15_ONE);
+#else
+        _twiddle_cos[k] = cosf(angle);
+        _twiddle_sin[k] = sinf(angle);
+#endif
+    }
+    
+    uint32_t bits = __builtin_ctz(_fft_half);
+    for (uint32_t i = 0; i < _fft_half; i++) {
+        uint32_t x = i;
+        uint32_t result = 0;
+        for (uint32_t b = 0; b < bits; b++) {
+            result = (result << 1) | (x & 1);
+            x >>= 1;
         }
+        _bit_reverse[i] = (uint16_t)result;
     }
+}
+
+/**
+ * @brief Build the log compression table (independent of the FFT size)
+ */
+static void build_log_lut(void) {
+    for (uint32_t i = 0; i <= LOG_LUT_SIZE; i++) {
+        float x = (float)i / LOG_LUT_SIZE;
+        _log_lut[i] = (uint16_t)lroundf(logf(1.0f + x * 10.0f) / logf(11.0f) * 65535.0f);
+    }
+}
+
+/**
+ * @brief Store one windowed sample into the packed, bit-reversed input
+ * 
+ * Packing and bit-reversal are folded into the load, so the FFT itself
+ * needs no permutation pass.
+ */
+static inline void load_sample(uint32_t i, fft_work_t value) {
+    uint32_t dst = _bit_reverse[i >> 1];
+    if (i & 1) {
+        _fft_imag[dst] = value;
+    } else {
+        _fft_real[dst] = value;
+    }
+}
+
+#if FFT_FIXED_POINT
+#define STAGE_SCALE(x) ((x) >> 1)   // Every stage halves (no overflow)
+#else
+#define STAGE_SCALE(x) (x)
+#endif
+
+/**
+ * @brief Butterfly stages 1 and 2 (sizes 2 and 4) fused into one pass
+ * 
+ * Their twiddles are 1 and -j, so four points at a time need only adds,
+ * and each point is loaded and stored once instead of twice.
+ */
+static inline void first_two_stages(fft_work_t *restrict re, fft_work_t *restrict im, uint32_t n) {
+    for (uint32_t i = 0; i < n; i += 4) {
+        // Stage 1: (0,1) and (2,3), W = 1
+        fft_work_t p_r = STAGE_SCALE(re[i] + re[i + 1]);
+        fft_work_t p_i = STAGE_SCALE(im[i] + im[i + 1]);
+        fft_work_t q_r = STAGE_SCALE(re[i] - re[i + 1]);
+        fft_work_t q_i = STAGE_SCALE(im[i] - im[i + 1]);
+        fft_work_t s_r = STAGE_SCALE(re[i + 2] + re[i + 3]);
+        fft_work_t s_i = STAGE_SCALE(im[i + 2] + im[i + 3]);
+        fft_work_t t_r = STAGE_SCALE(re[i + 2] - re[i + 3]);
+        fft_work_t t_i = STAGE_SCALE(im[i + 2] - im[i + 3]);
+        
+        // Stage 2: (0,2) with W = 1, (1,3) with W = -j (t * -j = t_i - j*t_r)
+        re[i] = STAGE_SCALE(p_r + s_r);
+        im[i] = STAGE_SCALE(p_i + s_i);
+        re[i + 2] = STAGE_SCALE(p_r - s_r);
+        im[i + 2] = STAGE_SCALE(p_i - s_i);
+        re[i + 1] = STAGE_SCALE(q_r + t_i);
+        im[i + 1] = STAGE_SCALE(q_i - t_r);
+        re[i + 3] = STAGE_SCALE(q_r - t_i);
+        im[i + 3] = STAGE_SCALE(q_i + t_r);
+    }
+}
+
+/**
+ * @brief In-place radix-2 complex FFT of N/2 points (input bit-reversed)
+ * 
+ * The fixed-point version halves every stage, so the result is Z / (N/2)
+ * and can never overflow.
+ */
+static void complex_fft_half(void) {
+    // Arena buffers never overlap
+    fft_work_t *restrict re = _fft_real;
+    fft_work_t *restrict im = _fft_imag;
+    const fft_work_t *restrict tw_cos = _twiddle_cos;
+    const fft_work_t *restrict tw_sin = _twiddle_sin;
     
-    // FFT butterfly operations
-    for (uint32_t size = 2; size <= n; size *= 2) {
-        float angle = -TWO_PI / size;
-        float wlen_r = cosf(angle);
-        float wlen_i = sinf(angle);
+    const uint32_t n = FFT_HALF_N;
+    first_two_stages(re, im, n);
+    
+    // Remaining stages; twiddle W_size^j = W_N^(j * N / size)
+    uint32_t stride = n / 4;
+    for (uint32_t size = 8; size <= n; size *= 2) {
+        uint32_t half = size / 2;
         
         for (uint32_t i = 0; i < n; i += size) {
-            float w_r = 1.0f;
-            float w_i = 0.0f;
-            
-            for (uint32_t j = 0; j < size / 2; j++) {
-                uint32_t idx1 = i + j;
-                uint32_t idx2 = i + j + size / 2;
+            for (uint32_t j = 0; j < half; j++) {
+                fft_work_t w_r = tw_cos[j * stride];
+                fft_work_t w_i = -tw_sin[j * stride];
                 
-                float u_r = real[idx1];
-                float u_i = imag[idx1];
-                float v_r = real[idx2] * w_r - imag[idx2] * w_i;
-                float v_i = real[idx2] * w_i + imag[idx2] * w_r;
+                uint32_t idx1 = i + j;
+                uint32_t idx2 = idx1 + half;
+
+#if FFT_FIXED_POINT
+                int32_t v_r = (re[idx2] * w_r - im[idx2] * w_i) >> 15;
+                int32_t v_i = (re[idx2] * w_i + im[idx2] * w_r) >> 15;
+                int32_t u_r = re[idx1];
+                int32_t u_i = im[idx1];
                 
-                real[idx1] = u_r + v_r;
-                imag[idx1] = u_i + v_i;
-                real[idx2] = u_r - v_r;
-                imag[idx2] = u_i - v_i;
+                re[idx1] = (u_r + v_r) >> 1;
+                im[idx1] = (u_i + v_i) >> 1;
+                re[idx2] = (u_r - v_r) >> 1;
+                im[idx2] = (u_i - v_i) >> 1;
+#else
+                float v_r = re[idx2] * w_r - im[idx2] * w_i;
+                float v_i = re[idx2] * w_i + im[idx2] * w_r;
+                float u_r = re[idx1];
+                float u_i = im[idx1];
                 
-                // Update twiddle factor
-                float w_r_temp = w_r * wlen_r - w_i * wlen_i;
-                w_i = w_r * wlen_i + w_i * wlen_r;
-                w_r = w_r_temp;
+                re[idx1] = u_r + v_r;
+                im[idx1] = u_i + v_i;
+                re[idx2] = u_r - v_r;
+                im[idx2] = u_i - v_i;
+#endif
             }
         }
+        
+        stride /= 2;
+    }
+}
+
+/**
+ * @brief Compute magnitudes of bins 0..N/2-1 of the real input
+ * 
+ * Splits the half-length complex spectrum Z into the spectrum X of the
+ * original real sequence:
+ *   X[k] = (Z[k] + Z*[M-k]) / 2  +  W_N^k * (Z[k] - Z*[M-k]) / 2j
+ */
+static void real_fft_magnitudes(fft_mag_t *magnitudes) {
+    complex_fft_half();
+    
+    const uint32_t n = FFT_HALF_N;
+    for (uint32_t k = 0; k < n; k++) {
+        uint32_t m = (n - k) & (n - 1);
+        
+        fft_work_t zr = _fft_real[k];
+        fft_work_t zi = _fft_imag[k];
+        fft_work_t cr = _fft_real[m];
+        fft_work_t ci = _fft_imag[m];
+        fft_work_t w_r = _twiddle_cos[k];
+        fft_work_t w_i = -_twiddle_sin[k];
+
+#if FFT_FIXED_POINT
+        // Even and odd sample spectra
+        int32_t even_r = (zr + cr) >> 1;
+        int32_t even_i = (zi - ci) >> 1;
+        int32_t odd_r = (zi + ci) >> 1;
+        int32_t odd_i = (cr - zr) >> 1;
+        
+        // Rotate odd part by W_N^k = cos - j*sin
+        int32_t x_r = even_r + ((odd_r * w_r - odd_i * w_i) >> 15);
+        int32_t x_i = even_i + ((odd_r * w_i + odd_i * w_r) >> 15);
+        
+        // |X| ~= alpha * max + beta * min
+        uint32_t a = (uint32_t)ABS(x_r);
+        uint32_t b = (uint32_t)ABS(x_i);
+        uint32_t hi = MAX(a, b);
+        uint32_t lo = MIN(a, b);
+        magnitudes[k] = (hi * MAG_ALPHA_Q15 + lo * MAG_BETA_Q15) >> 15;
+#else
+        // Even and odd sample spectra
+        float even_r = 0.5f * (zr + cr);
+        float even_i = 0.5f * (zi - ci);
+        float odd_r = 0.5f * (zi + ci);
+        float odd_i = -0.5f * (zr - cr);
+        
+        // Rotate odd part by W_N^k = cos - j*sin
+        float x_r = even_r + odd_r * w_r - odd_i * w_i;
+        float x_i = even_i + odd_r * w_i + odd_i * w_r;
+        
+        magnitudes[k] = sqrtf(x_r * x_r + x_i * x_i);
+#endif
+    }
+}
+
+// ============================================================================
+// Band Extraction
+// ============================================================================
+
+/**
+ * @brief Build the band plan for num_bands (no-op if already current)
+ * @return false if num_bands is out of range or the processor is not initialized
+ */
+static bool build_band_plan(uint8_t num_bands) {
+    if (num_bands == 0 || num_bands > BAND_COUNT_MAX || _fft_size == 0) return false;
+    if (num_bands == _band_plan_bands) return true;
+    
+    for (uint8_t band = 0; band < num_bands; band++) {
+        float f0, f1;
+        fft_processor_get_band_edges(band, num_bands, &f0, &f1);
+        
+        // Finest resolution: the lowest rate whose clean passband covers the band
+        uint8_t level = 0;
+        while (level + 1 < _levels &&
+               f1 <= FFT_MULTIRATE_PASSBAND * _sample_rate_hz / (float)(2u << level)) {
+            level++;
+        }
+        float rate = _sample_rate_hz / (float)(1u << level);
+        
+        // Convert frequencies to FFT bin indices
+        uint32_t bin0 = (uint32_t)(f0 * _fft_size / rate);
+        uint32_t bin1 = (uint32_t)(f1 * _fft_size / rate);
+        
+        // Clamp to valid range
+        if (bin0 >= _fft_half) bin0 = _fft_half - 1;
+        if (bin1 >= _fft_half) bin1 = _fft_half - 1;
+        if (bin1 <= bin0) bin1 = bin0 + 1;
+        
+        uint32_t count = bin1 - bin0;
+        band_plan_entry_t *entry = &_band_plan[band];
+        entry->bin_start = (uint16_t)bin0;
+        entry->bin_end = (uint16_t)bin1;
+        entry->level = level;
+        
+        // Averaging and FFT_DISPLAY_GAIN folded into one factor. A band
+        // averages over at least the N / N_ref bins that one bin of the
+        // reference transform (N_ref = FFT_LEVEL_REFERENCE_SIZE) spans, so a
+        // tone in a band narrower than that reads as it would at N_ref
+        float span = MAX((float)count, (float)_fft_size / FFT_LEVEL_REFERENCE_SIZE);
+#if FFT_FIXED_POINT
+        // Fixed magnitudes are the float ones scaled by 2^15 / (N/2), so
+        // level (Q16) = sum * (N/2) * 2^16 / (2^15 * FFT_DISPLAY_GAIN * span)
+        entry->weight = (uint32_t)lroundf(2.0f * _fft_half * 65536.0f / (FFT_DISPLAY_GAIN * span));
+#else
+        entry->weight = 1.0f / (FFT_DISPLAY_GAIN * span);
+#endif
+    }
+    
+    _band_plan_bands = num_bands;
+    return true;
+}
+
+/**
+ * @brief Apply log(1 + 10x) / log(11) compression to a linear level
+ * @param level_q16 Linear level, Q16 (values at or above 1.0 saturate)
+ * @return Display level (0.0 to 1.0)
+ */
+static float compress_level(uint32_t level_q16) {
+    if (level_q16 >= LEVEL_Q16_ONE) return 1.0f;
+    
+    uint32_t index = level_q16 >> (16 - LOG_LUT_BITS);
+    uint32_t frac = level_q16 & ((1u << (16 - LOG_LUT_BITS)) - 1);
+    uint32_t y0 = _log_lut[index];
+    uint32_t y1 = _log_lut[index + 1];
+    uint32_t y = y0 + (((y1 - y0) * frac) >> (16 - LOG_LUT_BITS));
+    
+    return (float)y * (1.0f / 65535.0f);
+}
+
+/**
+ * @brief Clamp a linear level and compress it for display
+ */
+static float display_level(float linear) {
+    return compress_level(linear < 1.0f ? (uint32_t)(linear * 65536.0f) : LEVEL_Q16_ONE);
+}
+
+/**
+ * @brief Run the FFT on the loaded input and extract frequency bands
+ * 
+ * Only bands owned by level are measured; all num_bands are written out,
+ * the rest from their last measurement.
+ */
+static bool compute_bands(uint8_t level, float *bands, uint8_t num_bands) {
+    if (!build_band_plan(num_bands)) return false;
+    
+    // Magnitude spectrum (only first half, due to symmetry)
+    fft_mag_t *magnitudes = _magnitudes;
+    PROFILE_BEGIN(fft);
+    real_fft_magnitudes(magnitudes);
+    _magnitudes_valid = true;
+    PROFILE_END(fft, PROF_FFT);
+    
+    PROFILE_BEGIN(bands);
+    for (uint8_t band = 0; band < num_bands; band++) {
+        const band_plan_entry_t *entry = &_band_plan[band];
+        if (entry->level != level) {
+            bands[band] = _held_bands[band];
+            continue;
+        }
+        
+        fft_mag_t sum = 0;
+        for (uint32_t bin = entry->bin_start; bin < entry->bin_end; bin++) {
+            sum += magnitudes[bin];
+        }
+
+#if FFT_FIXED_POINT
+        uint64_t linear = ((uint64_t)sum * entry->weight) >> 16;
+        bands[band] = compress_level(linear < LEVEL_Q16_ONE ? (uint32_t)linear : LEVEL_Q16_ONE);
+#else
+        bands[band] = display_level(sum * entry->weight);
+#endif
+        _held_bands[band] = bands[band];
     }
+    PROFILE_END(bands, PROF_BANDS);
+    
+    return true;
 }
 
 // ============================================================================
@@ -111,108 +507,157 @@ static void simple_fft(float *real, float *imag, uint32_t n) {
 // ============================================================================
 
 bool fft_processor_init(uint32_t sample_rate_hz) {
+    build_log_lut();
+    return fft_processor_configure(FFT_SIZE, sample_rate_hz);
+}
+
+bool fft_processor_configure(uint32_t fft_size, uint32_t sample_rate_hz) {
     if (sample_rate_hz == 0) return false;
+    if (fft_size < FFT_SIZE_MIN || fft_size > FFT_SIZE_MAX) return false;
+    if (fft_size & (fft_size - 1)) return false;
     
+    _fft_size = fft_size;
+    _fft_half = fft_size / 2;
     _sample_rate_hz = sample_rate_hz;
+    _band_plan_bands = 0;  // Bin mapping depends on size and sample rate
+    _magnitudes_valid = false;
+    memset(_held_bands, 0, sizeof(_held_bands));
     
-    // Generate Hann window
-    for (uint32_t i = 0; i < FFT_SIZE; i++) {
-        _window[i] = 0.5f * (1.0f - cosf(TWO_PI * i / (FFT_SIZE - 1)));
+    if (!allocate_buffers()) {
+        _fft_size = 0;
+        return false;
     }
+    build_tables();
+    
+    DEBUG_PRINTF("FFT processor configured: %lu Hz, size %lu (%s, %lu of %u arena bytes)\n",
+                 sample_rate_hz, fft_size, FFT_FIXED_POINT ? "Q15 fixed point" : "float",
+                 _arena_used, (unsigned)sizeof(_arena));
     
-    DEBUG_PRINTF("FFT processor initialized: %lu Hz, size %d\n", sample_rate_hz, FFT_SIZE);
+    return true;
+}
+
+bool fft_processor_set_levels(uint8_t levels) {
+    if (levels == 0 || levels > FFT_MULTIRATE_LEVELS_MAX) return false;
+    if (levels == _levels) return true;
     
+    // Bands move between levels; start them from silence
+    _levels = levels;
+    _band_plan_bands = 0;
+    memset(_held_bands, 0, sizeof(_held_bands));
     return true;
 }
 
+uint8_t fft_processor_get_levels(void) {
+    return _levels;
+}
+
+uint32_t fft_processor_get_size(void) {
+    return _fft_size;
+}
+
+uint32_t fft_processor_get_sample_rate(void) {
+    return _sample_rate_hz;
+}
+
 bool fft_processor_compute(const uint16_t *samples, float *bands, uint8_t num_bands) {
-    if (!samples || !bands || num_bands == 0) return false;
+    if (!samples || !bands || num_bands == 0 || _fft_size == 0) return false;
     
-    // Convert samples to float and apply window
+    // Convert samples and apply window
     // ADC gives 12-bit values (0-4095), centered around 2048
-    for (uint32_t i = 0; i < FFT_SIZE; i++) {
-        // Remove DC offset and normalize to -1.0 to 1.0
-        float sample = ((float)samples[i] - 2048.0f) / 2048.0f;
-        _fft_input[i] = sample * _window[i];
-    }
-    
-    // Initialize imaginary part to zero
-    memset(_fft_output, 0, sizeof(_fft_output));
-    
-    // Perform FFT
-    simple_fft(_fft_input, _fft_output, FFT_SIZE);
-    
-    // Calculate magnitude spectrum (only first half, due to symmetry)
-    float magnitudes[FFT_SIZE / 2];
-    for (uint32_t i = 0; i < FFT_SIZE / 2; i++) {
-        float real = _fft_input[i];
-        float imag = _fft_output[i];
-        magnitudes[i] = sqrtf(real * real + imag * imag);
+    const uint32_t n = FFT_N;
+    for (uint32_t i = 0; i < n; i++) {
+        fft_sample_t sample = FFT_SAMPLE_FROM_ADC(samples[i]);
+#if FFT_FIXED_POINT
+        load_sample(i, (sample * _window[i]) >> 15);
+#else
+        load_sample(i, sample * _window[i]);
+#endif
     }
     
-    // Extract frequency bands
-    // Use logarithmic spacing for more natural frequency distribution
-    float freq_min = FREQ_MIN_HZ;
-    float freq_max = FREQ_MAX_HZ;
-    float log_min = logf(freq_min);
-    float log_max = logf(freq_max);
+    return compute_bands(0, bands, num_bands);
+}
+
+bool fft_processor_compute_frame(const fft_sample_t *frame, float *bands, uint8_t num_bands) {
+    return fft_processor_compute_level(0, frame, bands, num_bands);
+}
+
+bool fft_processor_compute_level(uint8_t level, const fft_sample_t *frame,
+                                 float *bands, uint8_t num_bands) {
+    if (!frame || !bands || num_bands == 0 || _fft_size == 0) return false;
+    if (level >= _levels) return false;
     
-    for (uint8_t band = 0; band < num_bands; band++) {
-        // Calculate frequency range for this band (logarithmic)
-        float t0 = (float)band / num_bands;
-        float t1 = (float)(band + 1) / num_bands;
-        float f0 = expf(log_min + t0 * (log_max - log_min));
-        float f1 = expf(log_min + t1 * (log_max - log_min));
-        
-        // Convert frequencies to FFT bin indices
-        uint32_t bin0 = (uint32_t)(f0 * FFT_SIZE / _sample_rate_hz);
-        uint32_t bin1 = (uint32_t)(f1 * FFT_SIZE / _sample_rate_hz);
-        
-        // Clamp to valid range
-        if (bin0 >= FFT_SIZE / 2) bin0 = FFT_SIZE / 2 - 1;
-        if (bin1 >= FFT_SIZE / 2) bin1 = FFT_SIZE / 2 - 1;
-        if (bin1 <= bin0) bin1 = bin0 + 1;
-        
-        // Average magnitude across bins in this band
-        float sum = 0.0f;
-        uint32_t count = 0;
-        for (uint32_t bin = bin0; bin < bin1 && bin < FFT_SIZE / 2; bin++) {
-            sum += magnitudes[bin];
-            count++;
-        }
-        
-        float avg = (count > 0) ? (sum / count) : 0.0f;
-        
-        // Normalize and apply logarithmic scaling for better visualization
-        // Use configurable gain for display sensitivity
-        avg = avg / FFT_DISPLAY_GAIN;  // Adjust in config.h if needed
-        
-        // Apply logarithmic compression
-        if (avg > 0.0f) {
-            avg = logf(1.0f + avg * 10.0f) / logf(11.0f);
-        }
-        
-        // Clamp to 0-1 range
-        if (avg < 0.0f) avg = 0.0f;
-        if (avg > 1.0f) avg = 1.0f;
-        
-        bands[band] = avg;
+    // Frame is already normalized; windowing is fused into the load that
+    // the in-place FFT needs anyway
+    const uint32_t n = FFT_N;
+    for (uint32_t i = 0; i < n; i++) {
+#if FFT_FIXED_POINT
+        load_sample(i, (frame[i] * _window[i]) >> 15);
+#else
+        load_sample(i, frame[i] * _window[i]);
+#endif
     }
     
-    return true;
+    return compute_bands(level, bands, num_bands);
 }
 
-void fft_processor_get_band_range(uint8_t band_index, uint8_t num_bands, 
-                                   float *freq_min, float *freq_max) {
-    if (!freq_min || !freq_max || num_bands == 0) return;
+void fft_processor_get_band_edges(uint8_t band_index, uint8_t num_bands,
+                                  float *freq_min, float *freq_max) {
+    if (!freq_min || !freq_max) return;
     
+    if (band_index >= num_bands || _sample_rate_hz == 0) {
+        *freq_min = 0.0f;
+        *freq_max = 0.0f;
+        return;
+    }
+    
+    // Use logarithmic spacing for more natural frequency distribution
+    // (capped at Nyquist for low sample rates)
     float log_min = logf(FREQ_MIN_HZ);
-    float log_max = logf(FREQ_MAX_HZ);
+    float log_max = logf(MIN(FREQ_MAX_HZ, _sample_rate_hz / 2));
     
     float t0 = (float)band_index / num_bands;
     float t1 = (float)(band_index + 1) / num_bands;
-    
     *freq_min = expf(log_min + t0 * (log_max - log_min));
     *freq_max = expf(log_min + t1 * (log_max - log_min));
 }
 
+float fft_processor_display_level(float linear) {
+    return display_level(linear);
+}
+
+uint32_t fft_processor_get_magnitudes(uint16_t *bins, uint32_t max_bins) {
+    if (!bins || !_magnitudes_valid) return 0;
+    
+    uint32_t n = MIN(_fft_half, max_bins);
+#if FFT_FIXED_POINT
+    // Same scaling as a one-bin band (span N / N_ref):
+    // level (Q16) = mag * N_ref / FFT_DISPLAY_GAIN
+    uint32_t weight = (uint32_t)lroundf(FFT_LEVEL_REFERENCE_SIZE * 65536.0f / FFT_DISPLAY_GAIN);
+    for (uint32_t k = 0; k < n; k++) {
+        uint64_t level = ((uint64_t)_magnitudes[k] * weight) >> 16;
+        bins[k] = (level < 0xFFFF) ? (uint16_t)level : 0xFFFF;
+    }
+#else
+    for (uint32_t k = 0; k < n; k++) {
+        float level = _magnitudes[k] * (65536.0f * FFT_LEVEL_REFERENCE_SIZE / (_fft_size * FFT_DISPLAY_GAIN));
+        bins[k] = (level < 65535.0f) ? (uint16_t)level : 0xFFFF;
+    }
+#endif
+    return n;
+}
+
+void fft_processor_get_band_range(uint8_t band_index, uint8_t num_bands,
+                                   float *freq_min, float *freq_max) {
+    if (!freq_min || !freq_max) return;
+    
+    if (band_index >= num_bands || !build_band_plan(num_bands)) {
+        *freq_min = 0.0f;
+        *freq_max = 0.0f;
+        return;
+    }
+    
+    // Report the bins actually measured, not the nominal log-spaced edges
+    float bin_hz = (float)_sample_rate_hz / (_fft_size << _band_plan[band_index].level);
+    *freq_min = _band_plan[band_index].bin_start * bin_hz;
+    *freq_max = _band_plan[band_index].bin_end * bin_hz;
+}
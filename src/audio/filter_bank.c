@@ -0,0 +1,215 @@
+/**
+ * @file filter_bank.c
+ * @brief Constant-Q filter bank implementation
+ * 
+ * Each band is a Hann-windowed DFT of a single bin, evaluated sample by
+ * sample: a phase-accumulator oscillator at the band centre mixes the
+ * input down and two accumulators integrate it over the band's block.
+ * This is the windowed form of the Goertzel filter; unlike the Goertzel
+ * recurrence it keeps Q15 state within 32 bits for long, low-frequency
+ * blocks and needs no 64-bit products on the Cortex-M0+.
+ * 
+ * Block length is set so the window's half-power width equals the band
+ * width, which gives constant Q across log-spaced bands.
+ */
+
+#include "audio/filter_bank.h"
+#include "utils/profiler.h"
+#include "config.h"
+#include <math.h>
+#include <string.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define SINE_BITS           10
+#define SINE_SIZE           (1 << SINE_BITS)
+#define SINE_MASK           (SINE_SIZE - 1)
+
+#define BLOCK_MIN           16      // Shortest block (treble bands)
+#define BLOCK_MAX           4096    // Longest block (keeps Q15 sums within 32 bits)
+#define HANN_HALF_POWER_BINS 1.44f  // -3 dB width of the Hann main lobe
+
+#if FFT_FIXED_POINT
+typedef int16_t osc_t;          // Oscillator and window values, Q15
+typedef int32_t acc_t;          // Accumulator, Q15 (at most BLOCK_MAX * 2^15)
+#else
+typedef float osc_t;
+typedef float acc_t;
+#endif
+
+/**
+ * @brief State of one band filter
+ */
+typedef struct {
+    uint32_t phase_step;        // Oscillator increment per sample (2^32 * f / fs)
+    uint32_t phase;
+    uint32_t window_step;       // Window increment per sample (2^32 / block)
+    uint32_t window_phase;
+    uint16_t block;             // Samples per measurement
+    uint16_t count;             // Samples accumulated in the current block
+    acc_t re;                   // Windowed DFT accumulators
+    acc_t im;
+    float scale;                // |X| -> linear level
+    float center_hz;
+    float level;                // Latest display level
+} band_filter_t;
+
+// ============================================================================
+// Private State
+// ============================================================================
+
+static osc_t _sine[SINE_SIZE];
+static bool _sine_ready = false;
+
+static band_filter_t _filters[BAND_COUNT_MAX];
+static uint8_t _num_bands = 0;
+static uint32_t _sample_rate_hz = 0;
+
+// ============================================================================
+// Private Functions
+// ============================================================================
+
+static void build_sine_table(void) {
+    for (uint32_t i = 0; i < SINE_SIZE; i++) {
+        float v = sinf(2.0f * (float)M_PI * i / SINE_SIZE);
+#if FFT_FIXED_POINT
+        _sine[i] = (osc_t)lroundf(v * 32767.0f);
+#else
+        _sine[i] = v;
+#endif
+    }
+    _sine_ready = true;
+}
+
+static inline osc_t sine_at(uint32_t phase) {
+    return _sine[phase >> (32 - SINE_BITS)];
+}
+
+static inline osc_t cosine_at(uint32_t phase) {
+    return _sine[((phase >> (32 - SINE_BITS)) + SINE_SIZE / 4) & SINE_MASK];
+}
+
+/**
+ * @brief Display level of a completed block
+ */
+static float block_level(const band_filter_t *f, acc_t re, acc_t im) {
+#if FFT_FIXED_POINT
+    float x_r = re * (1.0f / 32768.0f);
+    float x_i = im * (1.0f / 32768.0f);
+#else
+    float x_r = re;
+    float x_i = im;
+#endif
+    return fft_processor_display_level(sqrtf(x_r * x_r + x_i * x_i) * f->scale);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool filter_bank_configure(uint32_t sample_rate_hz, uint8_t num_bands) {
+    if (sample_rate_hz == 0 || num_bands == 0 || num_bands > BAND_COUNT_MAX) return false;
+    
+    if (!_sine_ready) {
+        build_sine_table();
+    }
+    
+    for (uint8_t band = 0; band < num_bands; band++) {
+        float f0, f1;
+        fft_processor_get_band_edges(band, num_bands, &f0, &f1);
+        if (f1 <= f0) return false;
+        
+        // Half-power width of the window spans the band
+        float block = HANN_HALF_POWER_BINS * sample_rate_hz / (f1 - f0);
+        uint32_t n = (uint32_t)CLAMP(lroundf(block), BLOCK_MIN, BLOCK_MAX);
+        
+        band_filter_t *f = &_filters[band];
+        memset(f, 0, sizeof(*f));
+        f->center_hz = sqrtf(f0 * f1);
+        f->phase_step = (uint32_t)(f->center_hz / sample_rate_hz * 4294967296.0f);
+        f->window_step = (uint32_t)((1ull << 32) / n);
+        f->block = (uint16_t)n;
+        
+        // A full-scale tone gives |X| = n / 4, like a tone in an n-point FFT;
+        // normalize to the FFT engine's reference size (not the active FFT
+        // size, which the engine's levels don't depend on) so they match
+        f->scale = (float)FFT_LEVEL_REFERENCE_SIZE / (n * FFT_DISPLAY_GAIN);
+    }
+    
+    _num_bands = num_bands;
+    _sample_rate_hz = sample_rate_hz;
+    return true;
+}
+
+void filter_bank_push(const fft_sample_t *samples, uint32_t count) {
+    if (!samples) return;
+    
+    PROFILE_BEGIN(bank);
+    for (uint8_t band = 0; band < _num_bands; band++) {
+        band_filter_t *f = &_filters[band];
+        
+        // Work on locals, the inner loop runs for every sample
+        uint32_t phase = f->phase;
+        uint32_t window_phase = f->window_phase;
+        uint32_t n = f->count;
+        acc_t re = f->re;
+        acc_t im = f->im;
+        
+        for (uint32_t i = 0; i < count; i++) {
+#if FFT_FIXED_POINT
+            // Hann = (1 - cos) / 2
+            int32_t hann = (32767 - cosine_at(window_phase)) >> 1;
+            int32_t x = (samples[i] * hann) >> 15;
+            re += (x * cosine_at(phase)) >> 15;
+            im += (x * sine_at(phase)) >> 15;
+#else
+            float x = samples[i] * 0.5f * (1.0f - cosine_at(window_phase));
+            re += x * cosine_at(phase);
+            im += x * sine_at(phase);
+#endif
+            phase += f->phase_step;
+            window_phase += f->window_step;
+            
+            if (++n == f->block) {
+                f->level = block_level(f, re, im);
+                re = 0;
+                im = 0;
+                n = 0;
+                window_phase = 0;
+            }
+        }
+        
+        f->phase = phase;
+        f->window_phase = window_phase;
+        f->count = (uint16_t)n;
+        f->re = re;
+        f->im = im;
+    }
+    PROFILE_END(bank, PROF_BANDS);
+}
+
+bool filter_bank_get_bands(float *bands, uint8_t num_bands) {
+    if (!bands || num_bands == 0 || num_bands != _num_bands) return false;
+    
+    for (uint8_t band = 0; band < num_bands; band++) {
+        bands[band] = _filters[band].level;
+    }
+    return true;
+}
+
+void filter_bank_get_band_range(uint8_t band_index, float *freq_min, float *freq_max) {
+    if (!freq_min || !freq_max) return;
+    
+    if (band_index >= _num_bands) {
+        *freq_min = 0.0f;
+        *freq_max = 0.0f;
+        return;
+    }
+    
+    const band_filter_t *f = &_filters[band_index];
+    float half_width = 0.5f * HANN_HALF_POWER_BINS * _sample_rate_hz / f->block;
+    *freq_min = MAX(f->center_hz - half_width, 0.0f);
+    *freq_max = f->center_hz + half_width;
+}
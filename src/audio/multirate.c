@@ -0,0 +1,171 @@
+/**
+ * @file multirate.c
+ * @brief Half-band decimation chain implementation
+ * 
+ * Each stage is an 11-tap maximally flat half-band FIR (coefficients
+ * 3, 0, -25, 0, 150, 256, 150, 0, -25, 0, 3 over 512): every other tap is
+ * zero, so one output costs four multiplies. Passband droop is 0.2 dB and
+ * aliases are 32 dB down up to FFT_MULTIRATE_PASSBAND of the output rate.
+ * 
+ * Decimated samples go into a mirrored ring per level, exactly like the
+ * stft_framer history, so frames are always contiguous.
+ */
+
+#include "audio/multirate.h"
+#include "config.h"
+#include <string.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define HALFBAND_TAPS   11
+#define HALFBAND_DELAY  (HALFBAND_TAPS - 1)     // Input samples carried between blocks
+#define HOP_MAX         FFT_SIZE_MAX                 // Hop never exceeds the frame
+#define DECIMATORS      (FFT_MULTIRATE_LEVELS_MAX - 1)
+
+_Static_assert(FFT_MULTIRATE_LEVELS_MAX >= 1 && FFT_MULTIRATE_LEVELS_MAX <= 8,
+               "FFT_MULTIRATE_LEVELS_MAX must be 1 to 8 (ready mask is 8 bits)");
+_Static_assert(FFT_MULTIRATE_LEVELS >= 1 && FFT_MULTIRATE_LEVELS <= FFT_MULTIRATE_LEVELS_MAX,
+               "FFT_MULTIRATE_LEVELS out of range");
+_Static_assert((FFT_HOP_FOR(FFT_SIZE_MIN) >> DECIMATORS) >= 1,
+               "Hop at FFT_SIZE_MIN too short for the decimation chain");
+
+typedef struct {
+    fft_sample_t delay[HALFBAND_DELAY];     // Tail of the previous input block
+    fft_sample_t history[2 * FFT_SIZE_MAX]; // Mirrored frame ring at this level's rate
+    uint32_t head;                          // Oldest sample of the current frame
+    uint32_t pending;                       // Samples of the next hop received so far
+    uint32_t filled;                        // Samples received since configure (saturates)
+} level_state_t;
+
+// ============================================================================
+// Private State
+// ============================================================================
+
+static level_state_t _state[DECIMATORS > 0 ? DECIMATORS : 1];
+static uint8_t _levels = 1;
+static uint32_t _frame_size = FFT_SIZE;
+static uint32_t _hop_size = FFT_HOP_SIZE;   // Per level, at that level's rate
+
+static fft_sample_t _scratch[HALFBAND_DELAY + HOP_MAX];  // Delay line + input block
+static fft_sample_t _decimated[HOP_MAX / 2];             // Output of the last stage run
+
+// ============================================================================
+// Private Functions
+// ============================================================================
+
+/**
+ * @brief One half-band output from the 11 inputs starting at x
+ */
+static inline fft_sample_t halfband(const fft_sample_t *x) {
+#if FFT_FIXED_POINT
+    int32_t acc = 256 * x[5] + 150 * (x[4] + x[6]) - 25 * (x[2] + x[8]) + 3 * (x[0] + x[10]);
+    acc = (acc + 256) >> 9;
+    return (fft_sample_t)CLAMP(acc, -32768, 32767);
+#else
+    float acc = 256.0f * x[5] + 150.0f * (x[4] + x[6]) - 25.0f * (x[2] + x[8]) + 3.0f * (x[0] + x[10]);
+    return acc * (1.0f / 512.0f);
+#endif
+}
+
+/**
+ * @brief Low-pass and drop every other sample
+ * @param count Input samples (even); count / 2 are written to out
+ */
+static void decimate(level_state_t *st, const fft_sample_t *in, uint32_t count, fft_sample_t *out) {
+    // Contiguous delay line + block, so the filter never wraps
+    memcpy(_scratch, st->delay, sizeof(st->delay));
+    memcpy(&_scratch[HALFBAND_DELAY], in, count * sizeof(fft_sample_t));
+    
+    // Output i ends on input 2i + 1 of this block
+    for (uint32_t i = 0; i < count / 2; i++) {
+        out[i] = halfband(&_scratch[2 * i + 1]);
+    }
+    
+    memcpy(st->delay, &_scratch[count], sizeof(st->delay));
+}
+
+/**
+ * @brief Append decimated samples to a level's frame ring
+ * @return true when this completed a hop and the frame is full
+ */
+static bool level_push(level_state_t *st, const fft_sample_t *samples, uint32_t count) {
+    // Overwrite the oldest hop (and its mirror) piecewise until it is complete
+    fft_sample_t *dst = &st->history[st->head + st->pending];
+    for (uint32_t i = 0; i < count; i++) {
+        dst[i] = samples[i];
+        dst[i + _frame_size] = samples[i];
+    }
+    
+    st->pending += count;
+    if (st->pending < _hop_size) return false;
+    
+    st->pending = 0;
+    st->head += _hop_size;
+    if (st->head >= _frame_size) st->head = 0;
+    
+    if (st->filled < _frame_size) st->filled += _hop_size;
+    return st->filled >= _frame_size;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool multirate_configure(uint32_t frame_size, uint8_t levels) {
+    if (levels == 0 || levels > FFT_MULTIRATE_LEVELS_MAX) return false;
+    if (frame_size < FFT_SIZE_MIN || frame_size > FFT_SIZE_MAX) return false;
+    
+    // Every level must receive a whole, even number of samples per hop
+    uint32_t hop = FFT_HOP_FOR(frame_size);
+    if (hop == 0 || frame_size % hop != 0) return false;
+    if ((hop >> (levels - 1)) == 0 || (hop & ((1u << (levels - 1)) - 1))) return false;
+    
+    _frame_size = frame_size;
+    _hop_size = hop;
+    _levels = levels;
+    
+    for (uint8_t i = 0; i + 1 < levels; i++) {
+        level_state_t *st = &_state[i];
+        memset(st->delay, 0, sizeof(st->delay));
+        memset(st->history, 0, 2 * frame_size * sizeof(fft_sample_t));
+        st->head = 0;
+        st->pending = 0;
+        st->filled = 0;
+    }
+    return true;
+}
+
+uint8_t multirate_push(const fft_sample_t *samples, uint32_t count) {
+    if (!samples) return 0;
+    
+    uint8_t ready = 0;
+    const fft_sample_t *in = samples;
+    
+    // Each stage reads the previous stage's output (decimate() copies its
+    // input before overwriting _decimated)
+    for (uint8_t level = 1; level < _levels; level++) {
+        level_state_t *st = &_state[level - 1];
+        decimate(st, in, count, _decimated);
+        count /= 2;
+        
+        if (level_push(st, _decimated, count)) {
+            ready |= 1u << level;
+        }
+        in = _decimated;
+    }
+    
+    return ready;
+}
+
+const fft_sample_t *multirate_frame(uint8_t level) {
+    if (level == 0 || level >= _levels) return NULL;
+    
+    const level_state_t *st = &_state[level - 1];
+    return &st->history[st->head];
+}
+
+uint8_t multirate_levels(void) {
+    return _levels;
+}
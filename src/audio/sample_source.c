@@ -0,0 +1,415 @@
+/**
+ * @file sample_source.c
+ * @brief Sample source implementation
+ * 
+ * Before recording, the region is erased one 4 KB sector per service run,
+ * so the scheduler runs the other tasks between erases. Each sector erase
+ * still stalls both cores for its duration (~45 ms typical, up to 400 ms):
+ * the display stutters, and the live ADC ring can overrun, during the
+ * erase phase (~12 s for 1 MB). Recording then stages every hop in a RAM
+ * ring (CAPTURE_STAGING_BYTES), and the flash service drains it a page at
+ * a time in the audio core's idle time, so while recording no task on
+ * either core waits longer than one page program. The ADC interrupt stays
+ * enabled through every flash operation, so the capture ping-pong is
+ * re-armed on time. A full staging ring or the end of the region ends
+ * the recording cleanly at the last whole hop.
+ * 
+ * Replay copies each hop out of flash through the non-allocating XIP
+ * alias, so the capture streams past the XIP cache without evicting code
+ * and the pipeline reads RAM as it does live. The ADC keeps running at the
+ * capture's rate: its discarded blocks pace real-time replay and keep
+ * waking the audio core.
+ */
+
+#include "audio/sample_source.h"
+#include "audio/adc_sampler.h"
+#include "utils/spsc_ring.h"
+#include "hardware/flash.h"
+#include "hardware/irq.h"
+#include "hardware/regs/m0plus.h"
+#include "pico/multicore.h"
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define REGION_OFFSET   (PICO_FLASH_SIZE_BYTES - CAPTURE_FLASH_BYTES)  // From the start of flash
+#define DATA_OFFSET     (REGION_OFFSET + FLASH_SECTOR_SIZE)              // Header sector first
+#define DATA_BYTES      (CAPTURE_FLASH_BYTES - FLASH_SECTOR_SIZE)
+#define HOP_MAX         (FFT_SIZE_MAX / 2)                              // Largest hop (FFT_OVERLAP >= 0.5)
+
+_Static_assert(CAPTURE_FLASH_BYTES % FLASH_SECTOR_SIZE == 0 &&
+               CAPTURE_FLASH_BYTES >= 2 * FLASH_SECTOR_SIZE &&
+               CAPTURE_FLASH_BYTES < PICO_FLASH_SIZE_BYTES,
+               "CAPTURE_FLASH_BYTES must be whole 4 KB sectors, below the flash size");
+_Static_assert(FFT_HOP_FOR(FFT_SIZE_MAX) <= HOP_MAX, "HOP_MAX must hold a hop at FFT_SIZE_MAX");
+_Static_assert((CAPTURE_STAGING_BYTES & (CAPTURE_STAGING_BYTES - 1)) == 0 &&
+               CAPTURE_STAGING_BYTES % FLASH_PAGE_SIZE == 0,
+               "CAPTURE_STAGING_BYTES must be a power of 2 and whole flash pages");
+_Static_assert(CAPTURE_STAGING_BYTES >= 4 * HOP_MAX * sizeof(uint16_t),
+               "CAPTURE_STAGING_BYTES must hold a few hops at FFT_SIZE_MAX");
+
+// Linker symbol: end of the firmware image in flash
+extern char __flash_binary_end;
+
+// ============================================================================
+// Private State
+// ============================================================================
+
+typedef enum {
+    FLASH_IDLE = 0,
+    FLASH_ERASING,              // Erasing the region before recording
+    FLASH_WRITING,              // Recording, staged pages programmed as they fill
+    FLASH_FINISHING             // Writing out the last pages, then the header
+} flash_state_t;
+
+static bool _region_ok = false;
+static uint8_t _adc_channel = 0;
+
+// Requested by either core, applied by the audio core
+static volatile sample_source_mode_t _requested = SOURCE_LIVE;
+static sample_source_mode_t _mode = SOURCE_LIVE;
+static volatile flash_state_t _flash_state = FLASH_IDLE;
+
+// Recording (audio core only)
+static spsc_ring_t _staging;
+static uint8_t _staging_buffer[CAPTURE_STAGING_BYTES] __attribute__((aligned(4)));
+static uint8_t _page[FLASH_PAGE_SIZE] __attribute__((aligned(4)));  // Last page and header
+static uint32_t _erase_offset = 0;          // Region bytes erased so far
+static uint32_t _write_offset = 0;          // Flash offset of the next page
+static uint32_t _record_rate_hz = 0;
+static uint32_t _record_samples = 0;
+
+// Replay (audio core only)
+static uint16_t _replay_block[HOP_MAX];
+static uint32_t _acquired = 0;              // Samples of the replay block held by the reader
+static uint32_t _replay_pos = 0;            // Next sample of the capture
+static uint32_t _replay_credit = 0;         // Samples due in real time, from the ADC pace
+static uint32_t _replay_samples = 0;
+static uint32_t _replay_rate_hz = 0;
+static uint64_t _pass_start_us = 0;         // 0 until the pass takes its first block
+static uint32_t _passes = 0;
+
+// ============================================================================
+// Private Functions
+// ============================================================================
+
+/**
+ * @brief Complete capture in flash, if any
+ */
+static const capture_header_t *stored_capture(void) {
+    if (!_region_ok) return NULL;
+    
+    const capture_header_t *header = (const capture_header_t *)(XIP_BASE + REGION_OFFSET);
+    if (header->magic != CAPTURE_MAGIC || header->version != CAPTURE_VERSION) return NULL;
+    if (header->sample_rate_hz == 0 || header->num_samples < HOP_MAX ||
+        header->num_samples > DATA_BYTES / sizeof(uint16_t)) return NULL;
+    return header;
+}
+
+/**
+ * @brief Erase (data NULL) or program flash with only the ADC interrupt live
+ * 
+ * Core 1 waits in RAM, and every core 0 interrupt except the ADC DMA one
+ * is masked, so nothing runs from flash while XIP is off. The ADC handler
+ * runs from RAM and keeps re-arming the capture DMA meanwhile.
+ */
+static void flash_operation(uint32_t offset, const uint8_t *data, uint32_t bytes) {
+    multicore_lockout_start_blocking();
+    uint32_t masked = *(io_ro_32 *)(PPB_BASE + M0PLUS_NVIC_ISER_OFFSET) & ~(1u << DMA_IRQ_0);
+    irq_set_mask_enabled(masked, false);
+    
+    if (data) {
+        flash_range_program(offset, data, bytes);
+    } else {
+        flash_range_erase(offset, bytes);
+    }
+    
+    irq_set_mask_enabled(masked, true);
+    multicore_lockout_end_blocking();
+}
+
+/**
+ * @brief Program the next data page
+ */
+static void program_page(const uint8_t *data) {
+    flash_operation(_write_offset, data, FLASH_PAGE_SIZE);
+    _write_offset += FLASH_PAGE_SIZE;
+}
+
+/**
+ * @brief Stop taking blocks; staged pages and the header follow in the background
+ */
+static void finish_recording(const char *reason) {
+    _flash_state = FLASH_FINISHING;
+    _mode = SOURCE_LIVE;
+    _requested = SOURCE_LIVE;
+    printf("Capture: recording stopped (%s), writing out %lu samples\n", reason, _record_samples);
+}
+
+/**
+ * @brief Stage a live block for flash (recording, audio core)
+ */
+static void stage_block(const uint16_t *block, uint32_t count) {
+    uint32_t bytes = count * sizeof(uint16_t);
+    if ((_record_samples + count) * sizeof(uint16_t) > DATA_BYTES) {
+        finish_recording("capture region full");
+        return;
+    }
+    if (spsc_ring_free(&_staging) < bytes) {
+        finish_recording("flash writes fell behind");
+        return;
+    }
+    
+    spsc_ring_push(&_staging, block, bytes);
+    _record_samples += count;
+}
+
+/**
+ * @brief Program the header once all data is out, making the capture valid
+ */
+static void write_header(void) {
+    if (_record_samples < HOP_MAX) {
+        printf("Capture: too short, discarded\n");
+        return;
+    }
+    
+    capture_header_t header = {
+        .magic = CAPTURE_MAGIC,
+        .version = CAPTURE_VERSION,
+        .sample_rate_hz = _record_rate_hz,
+        .num_samples = _record_samples,
+        .adc_channel = _adc_channel,
+    };
+    memset(_page, 0xFF, sizeof(_page));
+    memcpy(_page, &header, sizeof(header));
+    flash_operation(REGION_OFFSET, _page, FLASH_PAGE_SIZE);
+    
+    printf("Capture: %lu samples (%.1f s) at %lu Hz saved\n",
+           _record_samples, (float)_record_samples / _record_rate_hz, _record_rate_hz);
+}
+
+/**
+ * @brief Print the throughput of a finished max-speed replay pass
+ */
+static void end_pass(uint32_t samples) {
+    float elapsed_s = (time_us_64() - _pass_start_us) / 1000000.0f;
+    float audio_s = (float)samples / _replay_rate_hz;
+    _passes++;
+    _pass_start_us = 0;
+    
+    printf("Replay: pass %lu, %.2f s of audio in %.3f s (%.2fx real time)\n",
+           _passes, audio_s, elapsed_s, (elapsed_s > 0.0f) ? audio_s / elapsed_s : 0.0f);
+}
+
+/**
+ * @brief Next block of the capture (replay modes)
+ */
+static const uint16_t *acquire_replay(uint32_t count) {
+    if (count == 0 || count > HOP_MAX) return NULL;
+    
+    // Live blocks are discarded; in real time each one makes as many
+    // capture samples due
+    while (adc_sampler_acquire_block(count) != NULL) {
+        adc_sampler_release_block();
+        if (_mode == SOURCE_REPLAY) _replay_credit += count;
+    }
+    if (_mode == SOURCE_REPLAY && _replay_credit < count) return NULL;
+    
+    // A partial last block is skipped, so every pass takes the same hops
+    if (_replay_pos + count > _replay_samples) {
+        uint32_t pass_samples = _replay_pos;
+        _replay_pos = 0;
+        if (_mode == SOURCE_REPLAY_FAST) {
+            end_pass(pass_samples);
+            return NULL;
+        }
+    }
+    
+    if (_pass_start_us == 0) _pass_start_us = time_us_64();
+    const uint16_t *capture = (const uint16_t *)(XIP_NOALLOC_BASE + DATA_OFFSET);
+    memcpy(_replay_block, &capture[_replay_pos], count * sizeof(uint16_t));
+    _acquired = count;
+    return _replay_block;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool sample_source_init(uint8_t adc_channel) {
+    _adc_channel = adc_channel;
+    spsc_ring_init(&_staging, _staging_buffer, 1, CAPTURE_STAGING_BYTES);
+    _requested = SOURCE_LIVE;
+    _mode = SOURCE_LIVE;
+    _flash_state = FLASH_IDLE;
+    _acquired = 0;
+    
+    _region_ok = (uintptr_t)&__flash_binary_end <= XIP_BASE + REGION_OFFSET;
+    if (!_region_ok) {
+        DEBUG_PRINTF("Sample source: firmware ends at 0x%08lx, past the capture region at 0x%08lx\n",
+                     (uint32_t)(uintptr_t)&__flash_binary_end, (uint32_t)(XIP_BASE + REGION_OFFSET));
+        return false;
+    }
+    
+    const capture_header_t *capture = stored_capture();
+    DEBUG_PRINTF("Sample source: %lu KB capture region at 0x%08lx, ",
+                 (uint32_t)(CAPTURE_FLASH_BYTES / 1024), (uint32_t)(XIP_BASE + REGION_OFFSET));
+    if (capture) {
+        DEBUG_PRINTF("capture of %lu samples at %lu Hz\n", capture->num_samples,
+                     capture->sample_rate_hz);
+    } else {
+        DEBUG_PRINTF("no capture\n");
+    }
+    return true;
+}
+
+bool sample_source_request(sample_source_mode_t mode) {
+    // The flash is busy until a recording has been written out
+    if (mode == SOURCE_RECORD && (!_region_ok || _flash_state != FLASH_IDLE)) return false;
+    if (mode >= SOURCE_REPLAY && (!stored_capture() || _flash_state != FLASH_IDLE)) return false;
+    
+    _requested = mode;
+    return true;
+}
+
+sample_source_mode_t sample_source_get_mode(void) {
+    return _requested;
+}
+
+bool sample_source_get_capture(uint32_t *sample_rate_hz, uint32_t *num_samples) {
+    const capture_header_t *capture = stored_capture();
+    if (!capture) return false;
+    
+    if (sample_rate_hz) *sample_rate_hz = capture->sample_rate_hz;
+    if (num_samples) *num_samples = capture->num_samples;
+    return true;
+}
+
+bool sample_source_update(void) {
+    sample_source_mode_t requested = _requested;
+    if (requested == _mode || _acquired) return false;
+    
+    bool was_replay = (_mode >= SOURCE_REPLAY);
+    if (_mode == SOURCE_RECORD) {
+        if (_flash_state == FLASH_ERASING) {
+            _flash_state = FLASH_IDLE;
+            printf("Capture: cancelled\n");
+        } else if (_flash_state == FLASH_WRITING) {
+            finish_recording("stopped");
+        }
+    }
+    
+    // Checked again here: the flash may have become busy since the request
+    const capture_header_t *capture = stored_capture();
+    if (requested == SOURCE_RECORD && _flash_state == FLASH_IDLE) {
+        _erase_offset = 0;
+        _flash_state = FLASH_ERASING;
+        printf("Capture: erasing %lu KB of flash...\n", (uint32_t)(CAPTURE_FLASH_BYTES / 1024));
+    } else if (requested >= SOURCE_REPLAY && capture && _flash_state == FLASH_IDLE) {
+        _replay_samples = capture->num_samples;
+        _replay_rate_hz = capture->sample_rate_hz;
+        _replay_pos = 0;
+        _replay_credit = 0;
+        _pass_start_us = 0;
+        _passes = 0;
+        printf("Replay: %lu samples (%.1f s) at %lu Hz, %s\n", _replay_samples,
+               (float)_replay_samples / _replay_rate_hz, _replay_rate_hz,
+               (requested == SOURCE_REPLAY_FAST) ? "max speed" : "real time");
+    } else if (requested != SOURCE_LIVE) {
+        requested = SOURCE_LIVE;
+        _requested = SOURCE_LIVE;
+    }
+    
+    _mode = requested;
+    return was_replay || _mode >= SOURCE_REPLAY;
+}
+
+uint32_t sample_source_available(void) {
+    switch (_mode) {
+        case SOURCE_REPLAY:
+            return _replay_credit + adc_sampler_available();
+        case SOURCE_REPLAY_FAST:
+            return _replay_samples;
+        default:
+            return adc_sampler_available();
+    }
+}
+
+const uint16_t *sample_source_acquire_block(uint32_t count) {
+    if (_requested != _mode || _acquired) return NULL;
+    if (_mode >= SOURCE_REPLAY) return acquire_replay(count);
+    
+    const uint16_t *block = adc_sampler_acquire_block(count);
+    if (block && _mode == SOURCE_RECORD && _flash_state == FLASH_WRITING) {
+        stage_block(block, count);
+    }
+    return block;
+}
+
+void sample_source_release_block(void) {
+    if (!_acquired) {
+        adc_sampler_release_block();
+        return;
+    }
+    
+    _replay_pos += _acquired;
+    if (_mode == SOURCE_REPLAY) _replay_credit -= _acquired;
+    _acquired = 0;
+}
+
+bool sample_source_flash_pending(void) {
+    switch (_flash_state) {
+        case FLASH_ERASING:
+        case FLASH_FINISHING:
+            return true;
+        case FLASH_WRITING:
+            return spsc_ring_available(&_staging) >= FLASH_PAGE_SIZE;
+        default:
+            return false;
+    }
+}
+
+bool sample_source_service(void) {
+    if (!sample_source_flash_pending()) return false;
+    
+    if (_flash_state == FLASH_ERASING) {
+        // One sector per run: the scheduler gets the cores back in between
+        flash_operation(REGION_OFFSET + _erase_offset, NULL, FLASH_SECTOR_SIZE);
+        _erase_offset += FLASH_SECTOR_SIZE;
+        if (_erase_offset >= CAPTURE_FLASH_BYTES) {
+            spsc_ring_reset(&_staging);
+            _write_offset = DATA_OFFSET;
+            _record_samples = 0;
+            _record_rate_hz = adc_sampler_get_rate();
+            _flash_state = FLASH_WRITING;
+            printf("Capture: recording at %lu Hz (up to %.1f s, 'c' stops)\n", _record_rate_hz,
+                   (float)(DATA_BYTES / sizeof(uint16_t)) / _record_rate_hz);
+        }
+        return true;
+    }
+    
+    // Staged pages are contiguous: the ring is whole pages, drained a page at a time
+    uint32_t staged = spsc_ring_available(&_staging);
+    if (staged >= FLASH_PAGE_SIZE) {
+        program_page(spsc_ring_read_ptr(&_staging));
+        spsc_ring_release(&_staging, FLASH_PAGE_SIZE);
+        return true;
+    }
+    
+    // Finishing: the last, partial page, then the header
+    if (staged > 0) {
+        memset(_page, 0xFF, sizeof(_page));
+        memcpy(_page, spsc_ring_read_ptr(&_staging), staged);
+        spsc_ring_release(&_staging, staged);
+        program_page(_page);
+        return true;
+    }
+    
+    write_header();
+    _flash_state = FLASH_IDLE;
+    return true;
+}
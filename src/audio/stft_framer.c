@@ -0,0 +1,83 @@
+/**
+ * @file stft_framer.c
+ * @brief Sliding-window framing implementation
+ * 
+ * The history is stored twice back to back (a "mirrored" ring), so the
+ * newest frame_size samples are always contiguous and can be handed to the
+ * FFT without reassembling the frame. Storage is sized for FFT_SIZE_MAX.
+ */
+
+#include "audio/stft_framer.h"
+#include "config.h"
+#include <string.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+_Static_assert(FFT_HOP_FOR(FFT_SIZE_MIN) > 0 && FFT_HOP_FOR(FFT_SIZE_MIN) <= FFT_SIZE_MIN,
+               "FFT_OVERLAP must be in [0, 1)");
+
+// ============================================================================
+// Private State
+// ============================================================================
+
+static fft_sample_t _history[2 * FFT_SIZE_MAX];
+static uint32_t _frame_size = FFT_SIZE;
+static uint32_t _hop_size = FFT_HOP_SIZE;
+static uint32_t _head = 0;        // Oldest sample of the current frame
+static uint32_t _filled = 0;      // Samples received since init (saturates)
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void stft_framer_init(void) {
+    stft_framer_configure(FFT_SIZE);
+}
+
+bool stft_framer_configure(uint32_t frame_size) {
+    if (frame_size < FFT_SIZE_MIN || frame_size > FFT_SIZE_MAX) return false;
+    
+    // Hop must tile the frame exactly
+    uint32_t hop = FFT_HOP_FOR(frame_size);
+    if (hop == 0 || frame_size % hop != 0) return false;
+    
+    _frame_size = frame_size;
+    _hop_size = hop;
+    memset(_history, 0, 2 * frame_size * sizeof(fft_sample_t));
+    _head = 0;
+    _filled = 0;
+    return true;
+}
+
+bool stft_framer_push(const uint16_t *samples) {
+    if (!samples) return false;
+    
+    // Overwrite the oldest hop (and its mirror), then slide the frame forward
+    fft_sample_t *dst = &_history[_head];
+    for (uint32_t i = 0; i < _hop_size; i++) {
+        // Remove DC offset and normalize to -1.0 to 1.0 (Q15 or float)
+        fft_sample_t sample = FFT_SAMPLE_FROM_ADC(samples[i]);
+        dst[i] = sample;
+        dst[i + _frame_size] = sample;
+    }
+    
+    _head += _hop_size;
+    if (_head >= _frame_size) _head = 0;
+    
+    if (_filled < _frame_size) _filled += _hop_size;
+    return _filled >= _frame_size;
+}
+
+const fft_sample_t *stft_framer_frame(void) {
+    return &_history[_head];
+}
+
+uint32_t stft_framer_hop_size(void) {
+    return _hop_size;
+}
+
+uint32_t stft_framer_frame_size(void) {
+    return _frame_size;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file gfx.c
+ * @brief Integer rasterization helpers
+ */
+
+#include "display/gfx.h"
+#include "config.h"
+#include <math.h>
+
+// ============================================================================
+// Circles
+// ============================================================================
+
+void gfx_circle_extents(uint16_t r, int16_t *extent) {
+    for (uint16_t dy = 0; dy <= r; dy++) {
+        extent[dy] = 0;
+    }
+    
+    // Walk one octant; each point gives the half-width of two rows
+    int16_t x = (int16_t)r;
+    int16_t y = 0;
+    int16_t err = 1 - (int16_t)r;
+    
+    while (x >= y) {
+        if (extent[y] < x) extent[y] = x;
+        if (extent[x] < y) extent[x] = y;
+        
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+}
+
+// ============================================================================
+// Lines
+// ============================================================================
+
+bool gfx_line_span(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t thickness,
+                   int16_t y, int16_t *x_start, int16_t *x_end) {
+    int16_t half = thickness / 2;
+    
+    // Walk the line top to bottom
+    if (y1 < y0) {
+        int16_t t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+    }
+    
+    // Line rows the brush reaches from this row
+    int16_t lo = MAX(y - half, y0);
+    int16_t hi = MIN(y + half, y1);
+    if (lo > hi) return false;
+    
+    int32_t dx = ABS(x1 - x0);
+    int32_t dy = y1 - y0;
+    int32_t first, last;    // Column offsets from x0 along the line
+    
+    if (dy == 0) {
+        first = 0;
+        last = dx;
+    } else if (dx <= dy) {
+        // Steep: one pixel per row, rounded to the nearest column
+        first = (2 * dx * (lo - y0) + dy) / (2 * dy);
+        last = (2 * dx * (hi - y0) + dy) / (2 * dy);
+    } else {
+        // Shallow: a row owns the columns whose line position rounds to it
+        int32_t start_num = dx * (2 * (lo - y0) - 1);
+        first = (start_num <= 0) ? 0 : (start_num + 2 * dy - 1) / (2 * dy);
+        last = (dx * (2 * (hi - y0) + 1) + 2 * dy - 1) / (2 * dy) - 1;
+        if (last > dx) last = dx;
+    }
+    
+    if (x1 >= x0) {
+        *x_start = (int16_t)(x0 + first - half);
+        *x_end = (int16_t)(x0 + last + half);
+    } else {
+        *x_start = (int16_t)(x0 - last - half);
+        *x_end = (int16_t)(x0 - first + half);
+    }
+    return true;
+}
+
+// ============================================================================
+// Angles
+// ============================================================================
+
+void gfx_angle_table(uint8_t count, int16_t *cos_q14, int16_t *sin_q14) {
+    for (uint8_t i = 0; i < count; i++) {
+        float angle = 2.0f * (float)M_PI * i / count;
+        cos_q14[i] = (int16_t)lroundf(cosf(angle) * GFX_TRIG_ONE);
+        sin_q14[i] = (int16_t)lroundf(sinf(angle) * GFX_TRIG_ONE);
+    }
+}
@@ -1,12 +1,28 @@
 /**
  * @file ili9341.c
  * @brief ILI9341 TFT Display Driver Implementation
+ * 
+ * Commands and parameters go out as 8-bit SPI frames. Pixel data switches
+ * the SPI to 16-bit frames (RGB565 words go out high byte first, no byte
+ * swapping) and is streamed by DMA_CHANNEL_DISPLAY: fills read a single
+ * colour word with a fixed read address, blits read an incrementing buffer.
+ * A transfer keeps CS asserted until it drains; every driver call that
+ * touches the bus first waits for the previous transfer. Completion is
+ * signalled by the channel's DMA_IRQ_1 interrupt (shared with the touch
+ * driver, same core), and waits sleep until it arrives.
+ * 
+ * Between ili9341_begin_transaction() and ili9341_end_transaction() CS stays
+ * asserted across primitives, and the address window only resends the
+ * column or page bounds that actually changed.
  */
 
 #include "display/ili9341.h"
 #include "config.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
 #include <string.h>
 
 // ============================================================================
@@ -16,39 +32,99 @@
 static uint16_t _width = ILI9341_TFTWIDTH;
 static uint16_t _height = ILI9341_TFTHEIGHT;
 static uint8_t _rotation = 0;
+static uint16_t _scroll_line = 0;            // Frame-memory line shown first (VSCRSADD)
+
+static uint8_t _spi_bits = 8;                 // Current SPI frame size
+static dma_channel_config _dma_config;       // 16-bit, SPI TX paced
+static volatile uint16_t _fill_color = 0;    // DMA source for fills
+static bool _dma_active = false;             // Transfer started, not yet waited for
+static volatile bool _dma_done = true;       // Set by the DMA-complete interrupt
+static bool _irq_installed = false;
+
+// Bus state: CS stays asserted while a transaction is open
+static bool _selected = false;
+static uint8_t _transaction_depth = 0;
+
+// Last column/page bounds sent (the controller latches them)
+static bool _window_valid = false;
+static uint16_t _window_x0, _window_x1;
+static uint16_t _window_y0, _window_y1;
 
 // ============================================================================
 // Low-Level SPI Communication
 // ============================================================================
 
 /**
- * @brief Write command byte to display
+ * @brief Switch the SPI frame size (bus must be idle)
  */
-static inline void write_command(uint8_t cmd) {
-    gpio_put(DISPLAY_PIN_DC, 0);  // Command mode
-    gpio_put(DISPLAY_PIN_CS, 0);  // Select display
-    spi_write_blocking(DISPLAY_SPI_PORT, &cmd, 1);
-    gpio_put(DISPLAY_PIN_CS, 1);  // Deselect
+static inline void set_data_bits(uint8_t bits) {
+    if (bits == _spi_bits) return;
+    spi_set_format(DISPLAY_SPI_PORT, bits, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    _spi_bits = bits;
 }
 
 /**
- * @brief Write single data byte to display
+ * @brief Assert CS (no-op if already selected)
  */
-static inline void write_data(uint8_t data) {
+static inline void select_display(void) {
+    if (_selected) return;
+    gpio_put(DISPLAY_PIN_CS, 0);
+    _selected = true;
+}
+
+/**
+ * @brief Deassert CS unless a transaction or pixel transfer is still open
+ */
+static inline void release_if_idle(void) {
+    if (!_selected || _transaction_depth > 0 || _dma_active) return;
+    gpio_put(DISPLAY_PIN_CS, 1);
+    _selected = false;
+}
+
+/**
+ * @brief Start streaming count pixels to display RAM (after RAMWR)
+ * @param src Pixel source; must stay valid until the transfer completes
+ * @param increment true for a buffer, false to repeat a single colour
+ */
+static void start_pixel_dma(const volatile uint16_t *src, bool increment, uint32_t count) {
+    set_data_bits(16);
     gpio_put(DISPLAY_PIN_DC, 1);  // Data mode
-    gpio_put(DISPLAY_PIN_CS, 0);  // Select display
-    spi_write_blocking(DISPLAY_SPI_PORT, &data, 1);
-    gpio_put(DISPLAY_PIN_CS, 1);  // Deselect
+    select_display();
+    
+    dma_channel_config c = _dma_config;
+    channel_config_set_read_increment(&c, increment);
+    _dma_done = false;
+    _dma_active = true;
+    dma_channel_configure(DMA_CHANNEL_DISPLAY, &c, &spi_get_hw(DISPLAY_SPI_PORT)->dr,
+                          src, count, true);
+}
+
+/**
+ * @brief Pixel transfer complete (the last words may still be in the SPI FIFO)
+ */
+static void __not_in_flash_func(display_dma_irq_handler)(void) {
+    if (!(dma_hw->ints1 & (1u << DMA_CHANNEL_DISPLAY))) return;
+    dma_hw->ints1 = 1u << DMA_CHANNEL_DISPLAY;
+    _dma_done = true;
+}
+
+/**
+ * @brief Write command byte to display (leaves the display selected)
+ */
+static inline void write_command(uint8_t cmd) {
+    ili9341_wait();
+    set_data_bits(8);
+    gpio_put(DISPLAY_PIN_DC, 0);  // Command mode
+    select_display();
+    spi_write_blocking(DISPLAY_SPI_PORT, &cmd, 1);
 }
 
 /**
- * @brief Write multiple data bytes to display
+ * @brief Write multiple data bytes to display (follows write_command)
  */
 static inline void write_data_buf(const uint8_t *buf, size_t len) {
     gpio_put(DISPLAY_PIN_DC, 1);  // Data mode
-    gpio_put(DISPLAY_PIN_CS, 0);  // Select display
     spi_write_blocking(DISPLAY_SPI_PORT, buf, len);
-    gpio_put(DISPLAY_PIN_CS, 1);  // Deselect
 }
 
 /**
@@ -59,6 +135,16 @@ static void write_command_data(uint8_t cmd, const uint8_t *data, size_t len) {
     if (len > 0) {
         write_data_buf(data, len);
     }
+    release_if_idle();
+}
+
+/**
+ * @brief Send a CASET/PASET range as one 4-byte burst
+ */
+static inline void write_range(uint8_t cmd, uint16_t start, uint16_t end) {
+    uint8_t buf[4] = {start >> 8, start & 0xFF, end >> 8, end & 0xFF};
+    write_command(cmd);
+    write_data_buf(buf, sizeof(buf));
 }
 
 // ============================================================================
@@ -71,6 +157,26 @@ bool ili9341_init(void) {
     
     // Set SPI format: 8 bits, SPI mode 0
     spi_set_format(DISPLAY_SPI_PORT, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    _spi_bits = 8;
+    _window_valid = false;
+    
+    // Pixel DMA: 16-bit words into the SPI TX FIFO, read side set per transfer
+    if (!dma_channel_is_claimed(DMA_CHANNEL_DISPLAY)) {
+        dma_channel_claim(DMA_CHANNEL_DISPLAY);
+    }
+    _dma_config = dma_channel_get_default_config(DMA_CHANNEL_DISPLAY);
+    channel_config_set_transfer_data_size(&_dma_config, DMA_SIZE_16);
+    channel_config_set_write_increment(&_dma_config, false);
+    channel_config_set_dreq(&_dma_config, spi_get_dreq(DISPLAY_SPI_PORT, true));
+    
+    // Completion interrupt on the calling (display) core
+    if (!_irq_installed) {
+        dma_channel_set_irq1_enabled(DMA_CHANNEL_DISPLAY, true);
+        irq_add_shared_handler(DMA_IRQ_1, display_dma_irq_handler,
+                               PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_1, true);
+        _irq_installed = true;
+    }
     
     // Initialize GPIO pins
     gpio_set_function(DISPLAY_PIN_SCK, GPIO_FUNC_SPI);
@@ -105,7 +211,7 @@ bool ili9341_init(void) {
     sleep_ms(150);
     
     // Software reset
-    write_command(ILI9341_SWRESET);
+    write_command_data(ILI9341_SWRESET, NULL, 0);
     sleep_ms(150);
     
     // Power control A
@@ -169,11 +275,11 @@ bool ili9341_init(void) {
     }, 15);
     
     // Sleep out
-    write_command(ILI9341_SLPOUT);
+    write_command_data(ILI9341_SLPOUT, NULL, 0);
     sleep_ms(120);
     
     // Display on
-    write_command(ILI9341_DISPON);
+    write_command_data(ILI9341_DISPON, NULL, 0);
     sleep_ms(20);
     
     DEBUG_PRINTF("ILI9341 initialized\n");
@@ -213,40 +319,59 @@ void ili9341_set_rotation(uint8_t rotation) {
     }
     
     write_command_data(ILI9341_MADCTL, &madctl, 1);
+    
+    // Column/page bounds are interpreted in the new orientation
+    _window_valid = false;
 }
 
 // ============================================================================
 // Drawing Functions
 // ============================================================================
 
+void ili9341_begin_transaction(void) {
+    _transaction_depth++;
+}
+
+void ili9341_end_transaction(void) {
+    if (_transaction_depth == 0) return;
+    _transaction_depth--;
+    
+    // A fill may still be streaming; CS is released when it is waited for
+    release_if_idle();
+}
+
 void ili9341_set_addr_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
-    write_command(ILI9341_CASET);  // Column address set
-    write_data(x0 >> 8);
-    write_data(x0 & 0xFF);
-    write_data(x1 >> 8);
-    write_data(x1 & 0xFF);
-    
-    write_command(ILI9341_PASET);  // Page address set
-    write_data(y0 >> 8);
-    write_data(y0 & 0xFF);
-    write_data(y1 >> 8);
-    write_data(y1 & 0xFF);
+    // The controller keeps its bounds, so only send the ones that changed
+    // (RAMWR restarts at the window origin either way)
+    if (!_window_valid || x0 != _window_x0 || x1 != _window_x1) {
+        write_range(ILI9341_CASET, x0, x1);  // Column address set
+        _window_x0 = x0;
+        _window_x1 = x1;
+    }
     
+    if (!_window_valid || y0 != _window_y0 || y1 != _window_y1) {
+        write_range(ILI9341_PASET, y0, y1);  // Page address set
+        _window_y0 = y0;
+        _window_y1 = y1;
+    }
+    
+    _window_valid = true;
     write_command(ILI9341_RAMWR);  // Memory write
 }
 
 void ili9341_begin_write(void) {
+    ili9341_wait();
+    set_data_bits(16);
     gpio_put(DISPLAY_PIN_DC, 1);  // Data mode
-    gpio_put(DISPLAY_PIN_CS, 0);  // Select display
+    select_display();
 }
 
 void ili9341_write_pixel(uint16_t color) {
-    uint8_t buf[2] = {color >> 8, color & 0xFF};
-    spi_write_blocking(DISPLAY_SPI_PORT, buf, 2);
+    spi_write16_blocking(DISPLAY_SPI_PORT, &color, 1);
 }
 
 void ili9341_end_write(void) {
-    gpio_put(DISPLAY_PIN_CS, 1);  // Deselect display
+    release_if_idle();
 }
 
 void ili9341_fill_screen(uint16_t color) {
@@ -266,18 +391,52 @@ void ili9341_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t colo
     if ((x >= _width) || (y >= _height)) return;
     if ((x + w - 1) >= _width) w = _width - x;
     if ((y + h - 1) >= _height) h = _height - y;
+    if ((w <= 0) || (h <= 0)) return;
     
+    // Waits for any previous transfer, so the fill colour is free to reuse
     ili9341_set_addr_window(x, y, x + w - 1, y + h - 1);
     
-    uint8_t hi = color >> 8;
-    uint8_t lo = color & 0xFF;
+    _fill_color = color;
+    start_pixel_dma(&_fill_color, false, (uint32_t)w * h);
+}
+
+void ili9341_blit_async(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels) {
+    if (!pixels || (w <= 0) || (h <= 0)) return;
+    if ((x < 0) || (y < 0) || ((x + w) > _width) || ((y + h) > _height)) return;
     
-    ili9341_begin_write();
-    for (int32_t i = (int32_t)w * h; i > 0; i--) {
-        uint8_t buf[2] = {hi, lo};
-        spi_write_blocking(DISPLAY_SPI_PORT, buf, 2);
+    ili9341_set_addr_window(x, y, x + w - 1, y + h - 1);
+    start_pixel_dma(pixels, true, (uint32_t)w * h);
+}
+
+void ili9341_blit(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels) {
+    ili9341_blit_async(x, y, w, h, pixels);
+    ili9341_wait();
+}
+
+bool ili9341_is_busy(void) {
+    return _dma_active && (!_dma_done || spi_is_busy(DISPLAY_SPI_PORT));
+}
+
+void ili9341_wait(void) {
+    if (!_dma_active) return;
+    
+    // Sleep until the completion interrupt; interrupts are masked around
+    // the check so it cannot fire between the check and the WFI (a pending
+    // interrupt still wakes the core)
+    while (!_dma_done) {
+        uint32_t status = save_and_disable_interrupts();
+        if (!_dma_done) __wfi();
+        restore_interrupts(status);
     }
-    ili9341_end_write();
+    
+    // DMA finishing only means the last word is in the FIFO; CS must stay
+    // low until it has been shifted out
+    while (spi_is_busy(DISPLAY_SPI_PORT)) {
+        tight_loop_contents();
+    }
+    
+    _dma_active = false;
+    release_if_idle();
 }
 
 void ili9341_draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
@@ -292,6 +451,49 @@ void ili9341_draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t colo
     ili9341_fill_rect(x + w - 1, y, 1, h, color);
 }
 
+// ============================================================================
+// Hardware Scrolling
+// ============================================================================
+
+void ili9341_set_scroll_area(uint16_t top_fixed, uint16_t bottom_fixed) {
+    if (top_fixed + bottom_fixed > ILI9341_TFTHEIGHT) return;
+    
+    uint16_t scroll_lines = ILI9341_TFTHEIGHT - top_fixed - bottom_fixed;
+    uint8_t data[6] = {
+        top_fixed >> 8, top_fixed & 0xFF,
+        scroll_lines >> 8, scroll_lines & 0xFF,
+        bottom_fixed >> 8, bottom_fixed & 0xFF
+    };
+    write_command_data(ILI9341_VSCRDEF, data, sizeof(data));
+}
+
+void ili9341_scroll_to(uint16_t line) {
+    _scroll_line = line;
+    uint8_t data[2] = {line >> 8, line & 0xFF};
+    write_command_data(ILI9341_VSCRSADD, data, sizeof(data));
+}
+
+void ili9341_scroll_reset(void) {
+    ili9341_set_scroll_area(0, 0);
+    ili9341_scroll_to(0);
+}
+
+bool ili9341_scroll_is_horizontal(void) {
+    // Rotations 1 and 3 set MV (row/column exchange)
+    return (_rotation & 1) != 0;
+}
+
+uint16_t ili9341_scroll_line_coord(uint16_t line) {
+    // Rotations 2 and 3 set MY, which reverses the line order
+    return (_rotation >= ILI9341_ROTATION_180) ? (ILI9341_TFTHEIGHT - 1 - line) : line;
+}
+
+uint16_t ili9341_scroll_screen_coord(uint16_t coord) {
+    // Panel position of the coordinate, then the line scrolled onto it
+    uint16_t line = (ili9341_scroll_line_coord(coord) + _scroll_line) % ILI9341_TFTHEIGHT;
+    return ili9341_scroll_line_coord(line);
+}
+
 // ============================================================================
 // Test Pattern
 // ============================================================================
@@ -0,0 +1,123 @@
+/**
+ * @file palette.c
+ * @brief Shared colour map implementation
+ * 
+ * The gradients are the ones the themes used to evaluate per segment or
+ * per row in float math; here they are evaluated once per table entry.
+ */
+
+#include "display/palette.h"
+#include "config.h"
+#include <stdbool.h>
+
+// ============================================================================
+// Private State
+// ============================================================================
+
+static uint16_t _palettes[PALETTE_COUNT][PALETTE_SIZE];
+static bool _initialized = false;
+
+// ============================================================================
+// Gradient Definitions
+// ============================================================================
+
+/**
+ * @brief Green → yellow → red, with yellow at amplitude 'knee'
+ */
+static uint16_t level_color(float amplitude, float knee) {
+    if (amplitude < knee) {
+        // Green to Yellow
+        float t = amplitude / knee;
+        uint8_t r = (uint8_t)(t * 255.0f);
+        return RGB565(r, 255, 0);
+    } else {
+        // Yellow to Red
+        float t = (amplitude - knee) / (1.0f - knee);
+        uint8_t g = (uint8_t)((1.0f - t) * 255.0f);
+        return RGB565(255, g, 0);
+    }
+}
+
+/**
+ * @brief Heat map: black → blue → cyan → green → yellow → red
+ */
+static uint16_t heat_color(float amplitude) {
+    if (amplitude < 0.2f) {
+        // Black to Blue
+        float t = amplitude / 0.2f;
+        uint8_t b = (uint8_t)(t * 255.0f);
+        return RGB565(0, 0, b);
+    } else if (amplitude < 0.4f) {
+        // Blue to Cyan
+        float t = (amplitude - 0.2f) / 0.2f;
+        uint8_t g = (uint8_t)(t * 255.0f);
+        return RGB565(0, g, 255);
+    } else if (amplitude < 0.6f) {
+        // Cyan to Green
+        float t = (amplitude - 0.4f) / 0.2f;
+        uint8_t b = (uint8_t)((1.0f - t) * 255.0f);
+        return RGB565(0, 255, b);
+    } else if (amplitude < 0.8f) {
+        // Green to Yellow
+        float t = (amplitude - 0.6f) / 0.2f;
+        uint8_t r = (uint8_t)(t * 255.0f);
+        return RGB565(r, 255, 0);
+    } else {
+        // Yellow to Red
+        float t = (amplitude - 0.8f) / 0.2f;
+        uint8_t g = (uint8_t)((1.0f - t) * 255.0f);
+        return RGB565(255, g, 0);
+    }
+}
+
+/**
+ * @brief Spectrum: blue → cyan → green → yellow → red
+ */
+static uint16_t spectrum_color(float amplitude) {
+    if (amplitude < 0.25f) {
+        // Blue to Cyan
+        float t = amplitude / 0.25f;
+        uint8_t g = (uint8_t)(t * 255.0f);
+        return RGB565(0, g, 255);
+    } else if (amplitude < 0.5f) {
+        // Cyan to Green
+        float t = (amplitude - 0.25f) / 0.25f;
+        uint8_t b = (uint8_t)((1.0f - t) * 255.0f);
+        return RGB565(0, 255, b);
+    } else if (amplitude < 0.75f) {
+        // Green to Yellow
+        float t = (amplitude - 0.5f) / 0.25f;
+        uint8_t r = (uint8_t)(t * 255.0f);
+        return RGB565(r, 255, 0);
+    } else {
+        // Yellow to Red
+        float t = (amplitude - 0.75f) / 0.25f;
+        uint8_t g = (uint8_t)((1.0f - t) * 255.0f);
+        return RGB565(255, g, 0);
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void palette_init(void) {
+    if (_initialized) return;
+    
+    for (uint32_t i = 0; i < PALETTE_SIZE; i++) {
+        float amplitude = (float)i / (PALETTE_SIZE - 1);
+        
+        _palettes[PALETTE_LEVEL][i] = level_color(amplitude, 0.5f);
+        _palettes[PALETTE_LEVEL_SOFT][i] = level_color(amplitude, 0.6f);
+        _palettes[PALETTE_HEAT][i] = heat_color(amplitude);
+        _palettes[PALETTE_SPECTRUM][i] = spectrum_color(amplitude);
+    }
+    
+    _initialized = true;
+    DEBUG_PRINTF("Palettes initialized: %d x %d entries\n", PALETTE_COUNT, PALETTE_SIZE);
+}
+
+const uint16_t *palette_get(palette_id_t id) {
+    if (id >= PALETTE_COUNT) id = PALETTE_LEVEL;
+    return _palettes[id];
+}
@@ -0,0 +1,537 @@
+/**
+ * @file strip_renderer.c
+ * @brief Strip-buffered renderer implementation
+ * 
+ * Two primitive lists are kept (this frame and the last one). At the end
+ * of a frame primitive i is compared with last frame's primitive i; any
+ * difference marks the old and new bounding boxes dirty. For rects and
+ * gradients that only grew or shrank vertically, only the rows in between
+ * are dirty, and a rect that slid along one axis only dirties its edges. Dirty areas are kept as a few rectangles per strip (so small
+ * changes far apart stay small), and each of them is rasterized (all
+ * primitives, painter's order) and blitted.
+ * 
+ * Strips are double-buffered: while DMA streams one strip buffer to the
+ * display, the next strip is rasterized into the other. The driver starts
+ * a transfer only after the previous one has finished, so at most one is
+ * in flight and it always reads the buffer filled before the current one;
+ * the CPU only waits when it gets a whole strip ahead of the wire.
+ */
+
+#include "display/strip_renderer.h"
+#include "display/ili9341.h"
+#include "display/gfx.h"
+#include "config.h"
+#include <string.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define STRIP_HEIGHT    DISPLAY_STRIP_HEIGHT
+#define MAX_DIMENSION   MAX(DISPLAY_WIDTH, DISPLAY_HEIGHT)  // Either rotation
+#define MAX_STRIPS      ((MAX_DIMENSION + STRIP_HEIGHT - 1) / STRIP_HEIGHT)
+#define MAX_PRIMITIVES  384
+#define DIRTY_PER_STRIP 4       // Separate dirty rectangles per strip
+#define MAX_RING_RADIUS MAX_DIMENSION
+
+typedef enum {
+    PRIM_FILL_RECT = 0,
+    PRIM_GRADIENT,
+    PRIM_LINE,
+    PRIM_RING,
+    PRIM_ROWS
+} prim_type_t;
+
+/**
+ * @brief One drawing command (16 bytes)
+ */
+typedef struct {
+    uint8_t type;           // prim_type_t
+    uint8_t param;          // Line thickness or gradient direction
+    uint16_t value;         // Colour, gradient origin row or rows version
+    int16_t a, b, c, d;     // Rect x/y/w/h, line x0/y0/x1/y1, ring cx/cy/r_in/r_out
+    const void *data;       // Gradient colour table or row callback
+} primitive_t;
+
+/**
+ * @brief Screen area, end coordinates exclusive
+ */
+typedef struct {
+    int16_t x0, y0, x1, y1;
+} region_t;
+
+// ============================================================================
+// Private State
+// ============================================================================
+
+static primitive_t _primitives[2][MAX_PRIMITIVES];
+static uint16_t _primitive_count[2] = {0, 0};
+static uint8_t _current = 0;                  // List being built this frame
+
+static uint16_t _background = 0;
+static bool _full_redraw = true;
+
+static int16_t _width = 0;
+static int16_t _height = 0;
+static uint8_t _num_strips = 0;
+
+// Dirty rectangles per strip (empty when x0 >= x1)
+static region_t _dirty[MAX_STRIPS][DIRTY_PER_STRIP];
+
+// Strip buffers: one on the wire while the other is rasterized
+static uint16_t _strip_buffers[2][MAX_DIMENSION * STRIP_HEIGHT];
+static uint8_t _next_buffer = 0;
+static uint16_t *_strip_pixels = _strip_buffers[0];  // Buffer being rasterized
+
+// Midpoint circle extents for the last outer and inner ring radius
+static int16_t _extents[2][MAX_RING_RADIUS + 1];
+static int16_t _extent_radius[2] = {-1, -1};
+
+// ============================================================================
+// Primitive List
+// ============================================================================
+
+/**
+ * @brief Append a primitive to this frame's list (dropped when full)
+ */
+static void add_primitive(uint8_t type, uint8_t param, uint16_t value,
+                          int16_t a, int16_t b, int16_t c, int16_t d, const void *data) {
+    uint16_t count = _primitive_count[_current];
+    if (count >= MAX_PRIMITIVES) return;
+    
+    primitive_t *p = &_primitives[_current][count];
+    p->type = type;
+    p->param = param;
+    p->value = value;
+    p->a = a;
+    p->b = b;
+    p->c = c;
+    p->d = d;
+    p->data = data;
+    
+    _primitive_count[_current] = count + 1;
+}
+
+static bool primitives_equal(const primitive_t *p, const primitive_t *q) {
+    return p->type == q->type && p->param == q->param && p->value == q->value &&
+           p->a == q->a && p->b == q->b && p->c == q->c && p->d == q->d &&
+           p->data == q->data;
+}
+
+/**
+ * @brief Screen area a primitive can touch
+ */
+static region_t primitive_bounds(const primitive_t *p) {
+    region_t r;
+    
+    switch (p->type) {
+        case PRIM_LINE: {
+            int16_t half = p->param / 2;
+            r.x0 = MIN(p->a, p->c) - half;
+            r.y0 = MIN(p->b, p->d) - half;
+            r.x1 = MAX(p->a, p->c) + half + 1;
+            r.y1 = MAX(p->b, p->d) + half + 1;
+            break;
+        }
+        case PRIM_RING:
+            r.x0 = p->a - p->d;
+            r.y0 = p->b - p->d;
+            r.x1 = p->a + p->d + 1;
+            r.y1 = p->b + p->d + 1;
+            break;
+        default:
+            r.x0 = p->a;
+            r.y0 = p->b;
+            r.x1 = p->a + p->c;
+            r.y1 = p->b + p->d;
+            break;
+    }
+    
+    return r;
+}
+
+static inline bool regions_overlap(const region_t *r, const region_t *s) {
+    return r->x0 < s->x1 && s->x0 < r->x1 && r->y0 < s->y1 && s->y0 < r->y1;
+}
+
+// ============================================================================
+// Dirty Tracking
+// ============================================================================
+
+static inline int32_t region_area(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    return (int32_t)(x1 - x0) * (y1 - y0);
+}
+
+/**
+ * @brief Add an area to one strip's dirty rectangles
+ * 
+ * Joins a rectangle whose columns it overlaps or touches, otherwise takes a
+ * free slot; with no slot left it merges into the rectangle that grows least.
+ */
+static void mark_strip_dirty(region_t *dirty, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    region_t *target = NULL;
+    int32_t best_growth = INT32_MAX;
+    
+    for (uint8_t i = 0; i < DIRTY_PER_STRIP; i++) {
+        region_t *d = &dirty[i];
+        if (d->x0 >= d->x1) {
+            if (!target) target = d;
+            continue;
+        }
+        if (x0 <= d->x1 && d->x0 <= x1) {
+            target = d;
+            break;
+        }
+    }
+    
+    if (target && target->x0 >= target->x1) {
+        target->x0 = x0;
+        target->x1 = x1;
+        target->y0 = y0;
+        target->y1 = y1;
+        return;
+    }
+    
+    if (!target) {
+        for (uint8_t i = 0; i < DIRTY_PER_STRIP; i++) {
+            region_t *d = &dirty[i];
+            int32_t growth = region_area(MIN(d->x0, x0), MIN(d->y0, y0),
+                                         MAX(d->x1, x1), MAX(d->y1, y1)) -
+                             region_area(d->x0, d->y0, d->x1, d->y1);
+            if (growth < best_growth) {
+                best_growth = growth;
+                target = d;
+            }
+        }
+    }
+    
+    target->x0 = MIN(target->x0, x0);
+    target->x1 = MAX(target->x1, x1);
+    target->y0 = MIN(target->y0, y0);
+    target->y1 = MAX(target->y1, y1);
+}
+
+/**
+ * @brief Add an area to the dirty rectangles of the strips it covers
+ */
+static void mark_dirty(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    x0 = MAX(x0, 0);
+    y0 = MAX(y0, 0);
+    x1 = MIN(x1, _width);
+    y1 = MIN(y1, _height);
+    if (x0 >= x1 || y0 >= y1) return;
+    
+    for (int16_t s = y0 / STRIP_HEIGHT; s <= (y1 - 1) / STRIP_HEIGHT; s++) {
+        mark_strip_dirty(_dirty[s], x0, MAX(y0, s * STRIP_HEIGHT),
+                         x1, MIN(y1, (s + 1) * STRIP_HEIGHT));
+    }
+}
+
+static inline void mark_region_dirty(const region_t *r) {
+    mark_dirty(r->x0, r->y0, r->x1, r->y1);
+}
+
+/**
+ * @brief Mark what changed between last frame's and this frame's primitive
+ */
+static void diff_primitive(const primitive_t *cur, const primitive_t *prev) {
+    if (primitives_equal(cur, prev)) return;
+    
+    // Same columns and fill, only the vertical extent moved: just the rows
+    // between the old and new edge changed
+    bool vertical_only = (cur->type == PRIM_FILL_RECT || cur->type == PRIM_GRADIENT) &&
+                         cur->type == prev->type && cur->param == prev->param &&
+                         cur->value == prev->value && cur->data == prev->data &&
+                         cur->a == prev->a && cur->c == prev->c;
+    if (vertical_only) {
+        int16_t prev_bottom = prev->b + prev->d;
+        int16_t cur_bottom = cur->b + cur->d;
+        
+        if (cur->b == prev->b) {
+            mark_dirty(cur->a, MIN(prev_bottom, cur_bottom), cur->a + cur->c,
+                       MAX(prev_bottom, cur_bottom));
+            return;
+        }
+        if (cur_bottom == prev_bottom) {
+            mark_dirty(cur->a, MIN(prev->b, cur->b), cur->a + cur->c, MAX(prev->b, cur->b));
+            return;
+        }
+    }
+    
+    // Same fill rect slid along one axis (e.g. pinned over a hardware
+    // scroll): only the uncovered and newly covered slivers changed
+    bool same_rect = cur->type == PRIM_FILL_RECT && prev->type == PRIM_FILL_RECT &&
+                     cur->value == prev->value && cur->c == prev->c && cur->d == prev->d;
+    if (same_rect && cur->b == prev->b && ABS(cur->a - prev->a) < cur->c) {
+        int16_t x0 = MIN(prev->a, cur->a), x1 = MAX(prev->a, cur->a);
+        mark_dirty(x0, cur->b, x1, cur->b + cur->d);
+        mark_dirty(x0 + cur->c, cur->b, x1 + cur->c, cur->b + cur->d);
+        return;
+    }
+    if (same_rect && cur->a == prev->a && ABS(cur->b - prev->b) < cur->d) {
+        int16_t y0 = MIN(prev->b, cur->b), y1 = MAX(prev->b, cur->b);
+        mark_dirty(cur->a, y0, cur->a + cur->c, y1);
+        mark_dirty(cur->a, y0 + cur->d, cur->a + cur->c, y1 + cur->d);
+        return;
+    }
+    
+    region_t r = primitive_bounds(prev);
+    mark_region_dirty(&r);
+    r = primitive_bounds(cur);
+    mark_region_dirty(&r);
+}
+
+// ============================================================================
+// Rasterization
+// ============================================================================
+
+/**
+ * @brief Fill columns x0..x1 (inclusive) of row y, clipped to the strip
+ */
+static inline void fill_span(const region_t *clip, int16_t y, int16_t x0, int16_t x1, uint16_t color) {
+    if (y < clip->y0 || y >= clip->y1) return;
+    if (x0 < clip->x0) x0 = clip->x0;
+    if (x1 >= clip->x1) x1 = clip->x1 - 1;
+    if (x0 > x1) return;
+    
+    uint16_t *dst = &_strip_pixels[(y - clip->y0) * (clip->x1 - clip->x0) + (x0 - clip->x0)];
+    for (int16_t x = x0; x <= x1; x++) {
+        *dst++ = color;
+    }
+}
+
+static void draw_line(const primitive_t *p, const region_t *clip) {
+    int16_t half = p->param / 2;
+    int16_t y_start = MAX(clip->y0, MIN(p->b, p->d) - half);
+    int16_t y_end = MIN(clip->y1, MAX(p->b, p->d) + half + 1);
+    
+    // One horizontal run per row
+    for (int16_t y = y_start; y < y_end; y++) {
+        int16_t x_start, x_end;
+        if (gfx_line_span(p->a, p->b, p->c, p->d, p->param, y, &x_start, &x_end)) {
+            fill_span(clip, y, x_start, x_end, p->value);
+        }
+    }
+}
+
+/**
+ * @brief Circle extents for a radius, cached (rings rarely change size)
+ */
+static const int16_t *circle_extents(uint8_t slot, int16_t r) {
+    if (_extent_radius[slot] != r) {
+        gfx_circle_extents((uint16_t)r, _extents[slot]);
+        _extent_radius[slot] = r;
+    }
+    return _extents[slot];
+}
+
+static void draw_ring(const primitive_t *p, const region_t *clip) {
+    int16_t cx = p->a, cy = p->b;
+    int16_t r_in = p->c, r_out = MIN(p->d, MAX_RING_RADIUS);
+    const int16_t *outer = circle_extents(0, r_out);
+    const int16_t *inner = circle_extents(1, MIN(r_in, r_out));
+    
+    int16_t y_start = MAX(clip->y0, cy - r_out);
+    int16_t y_end = MIN(clip->y1, cy + r_out + 1);
+    
+    for (int16_t y = y_start; y < y_end; y++) {
+        int16_t dy = ABS(y - cy);
+        
+        if (dy > r_in) {
+            fill_span(clip, y, cx - outer[dy], cx + outer[dy], p->value);
+        } else {
+            // Between the inner and outer outline on both sides
+            fill_span(clip, y, cx - outer[dy], cx - inner[dy], p->value);
+            fill_span(clip, y, cx + inner[dy], cx + outer[dy], p->value);
+        }
+    }
+}
+
+static void draw_primitive(const primitive_t *p, const region_t *clip) {
+    switch (p->type) {
+        case PRIM_FILL_RECT: {
+            int16_t y_end = MIN(clip->y1, p->b + p->d);
+            for (int16_t y = MAX(clip->y0, p->b); y < y_end; y++) {
+                fill_span(clip, y, p->a, p->a + p->c - 1, p->value);
+            }
+            break;
+        }
+        case PRIM_GRADIENT: {
+            const uint16_t *colors = (const uint16_t *)p->data;
+            int16_t origin = (int16_t)p->value;
+            int16_t y_end = MIN(clip->y1, p->b + p->d);
+            
+            for (int16_t y = MAX(clip->y0, p->b); y < y_end; y++) {
+                int16_t index = (p->param == GRADIENT_UP) ? (origin - y) : (y - origin);
+                if (index < 0) continue;
+                fill_span(clip, y, p->a, p->a + p->c - 1, colors[index]);
+            }
+            break;
+        }
+        case PRIM_LINE:
+            draw_line(p, clip);
+            break;
+        case PRIM_RING:
+            draw_ring(p, clip);
+            break;
+        case PRIM_ROWS: {
+            strip_row_fn_t row_fn = (strip_row_fn_t)p->data;
+            int16_t x0 = MAX(clip->x0, p->a);
+            int16_t x1 = MIN(clip->x1, p->a + p->c);
+            int16_t y_end = MIN(clip->y1, p->b + p->d);
+            if (x0 >= x1) break;
+            
+            for (int16_t y = MAX(clip->y0, p->b); y < y_end; y++) {
+                uint16_t *dst = &_strip_pixels[(y - clip->y0) * (clip->x1 - clip->x0) +
+                                               (x0 - clip->x0)];
+                row_fn(y, x0, (uint16_t)(x1 - x0), dst);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Rasterize one dirty strip rectangle and start sending it
+ */
+static void render_region(const region_t *clip) {
+    const primitive_t *list = _primitives[_current];
+    uint16_t count = _primitive_count[_current];
+    uint32_t pixels = (uint32_t)(clip->x1 - clip->x0) * (clip->y1 - clip->y0);
+    
+    // The other buffer may still be on the wire; this one is free
+    _strip_pixels = _strip_buffers[_next_buffer];
+    _next_buffer ^= 1;
+    
+    for (uint32_t i = 0; i < pixels; i++) {
+        _strip_pixels[i] = _background;
+    }
+    
+    for (uint16_t i = 0; i < count; i++) {
+        region_t bounds = primitive_bounds(&list[i]);
+        if (regions_overlap(&bounds, clip)) {
+            draw_primitive(&list[i], clip);
+        }
+    }
+    
+    // Waits for the previous strip to drain, then leaves this one streaming
+    ili9341_blit_async(clip->x0, clip->y0, clip->x1 - clip->x0, clip->y1 - clip->y0,
+                       _strip_pixels);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void strip_renderer_init(void) {
+    _width = (int16_t)ili9341_width();
+    _height = (int16_t)ili9341_height();
+    _num_strips = (uint8_t)((_height + STRIP_HEIGHT - 1) / STRIP_HEIGHT);
+    
+    _primitive_count[0] = 0;
+    _primitive_count[1] = 0;
+    _current = 0;
+    _background = ILI9341_BLACK;
+    
+    strip_renderer_invalidate();
+    
+    DEBUG_PRINTF("Strip renderer initialized: %dx%d, %d strips of %d rows\n",
+                 _width, _height, _num_strips, STRIP_HEIGHT);
+}
+
+void strip_renderer_begin_frame(uint16_t background) {
+    if (background != _background) {
+        _background = background;
+        _full_redraw = true;
+    }
+    
+    // The list built last frame becomes the reference for the diff
+    _current ^= 1;
+    _primitive_count[_current] = 0;
+}
+
+void strip_renderer_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (w <= 0) return;
+    add_primitive(PRIM_FILL_RECT, 0, color, x, y, w, MAX(h, 0), NULL);
+}
+
+void strip_renderer_gradient(int16_t x, int16_t y, int16_t w, int16_t h,
+                             const uint16_t *colors, int16_t origin, gradient_dir_t dir) {
+    if (w <= 0 || !colors) return;
+    add_primitive(PRIM_GRADIENT, (uint8_t)dir, (uint16_t)origin, x, y, w, MAX(h, 0), colors);
+}
+
+void strip_renderer_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                         uint16_t color, uint8_t thickness) {
+    if (thickness == 0) return;
+    add_primitive(PRIM_LINE, thickness, color, x0, y0, x1, y1, NULL);
+}
+
+void strip_renderer_ring(int16_t cx, int16_t cy, int16_t r_inner, int16_t r_outer, uint16_t color) {
+    if (r_outer < 0 || r_inner > r_outer) return;
+    add_primitive(PRIM_RING, 0, color, cx, cy, MAX(r_inner, 0), r_outer, NULL);
+}
+
+void strip_renderer_rows(int16_t x, int16_t y, int16_t w, int16_t h,
+                         strip_row_fn_t row_fn, uint16_t version) {
+    if (w <= 0 || h <= 0 || !row_fn) return;
+    add_primitive(PRIM_ROWS, 0, version, x, y, w, h, (const void *)row_fn);
+}
+
+uint16_t strip_renderer_end_frame(void) {
+    const primitive_t *cur = _primitives[_current];
+    const primitive_t *prev = _primitives[_current ^ 1];
+    uint16_t cur_count = _primitive_count[_current];
+    uint16_t prev_count = _primitive_count[_current ^ 1];
+    
+    if (_full_redraw) {
+        mark_dirty(0, 0, _width, _height);
+        _full_redraw = false;
+    } else {
+        uint16_t common = MIN(cur_count, prev_count);
+        for (uint16_t i = 0; i < common; i++) {
+            diff_primitive(&cur[i], &prev[i]);
+        }
+        
+        // Primitives that appeared or disappeared
+        for (uint16_t i = common; i < cur_count; i++) {
+            region_t r = primitive_bounds(&cur[i]);
+            mark_region_dirty(&r);
+        }
+        for (uint16_t i = common; i < prev_count; i++) {
+            region_t r = primitive_bounds(&prev[i]);
+            mark_region_dirty(&r);
+        }
+    }
+    
+    uint16_t regions_sent = 0;
+    for (uint8_t s = 0; s < _num_strips; s++) {
+        for (uint8_t i = 0; i < DIRTY_PER_STRIP; i++) {
+            region_t *d = &_dirty[s][i];
+            if (d->x0 >= d->x1) continue;
+            
+            render_region(d);
+            regions_sent++;
+            
+            d->x0 = d->x1 = 0;
+        }
+    }
+    
+    return regions_sent;
+}
+
+void strip_renderer_invalidate(void) {
+    _full_redraw = true;
+}
+
+void strip_renderer_clear(uint16_t background) {
+    // Waits for the previous transfer, then streams a single colour
+    ili9341_fill_rect(0, 0, _width, _height, background);
+    
+    // Next frame diffs against an empty screen of that colour
+    _background = background;
+    _primitive_count[_current] = 0;
+    _full_redraw = false;
+}
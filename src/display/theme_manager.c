@@ -1,6 +1,10 @@
 /**
  * @file theme_manager.c
  * @brief Theme management implementation
+ * 
+ * All themes (and the name overlay) draw through the strip renderer, one
+ * frame per theme_manager_render() call. Themes are driven through their
+ * theme_t tables and keep their state across switches.
  */
 
 #include "display/theme_manager.h"
@@ -9,6 +13,9 @@
 #include "display/themes/radial.h"
 #include "display/themes/mirror.h"
 #include "display/ili9341.h"
+#include "display/strip_renderer.h"
+#include "display/palette.h"
+#include "utils/profiler.h"
 #include "config.h"
 #include "pico/stdlib.h"
 
@@ -16,26 +23,53 @@
 // Private State
 // ============================================================================
 
+static const theme_t *const _themes[THEME_COUNT] = {
+    [THEME_BARS] = &bars_theme,
+    [THEME_WATERFALL] = &waterfall_theme,
+    [THEME_RADIAL] = &radial_theme,
+    [THEME_MIRROR] = &mirror_theme
+};
+
 static theme_type_t _current_theme = THEME_BARS;
 static bool _overlay_visible = false;
 static absolute_time_t _overlay_end_time;
 
-static const char* _theme_names[THEME_COUNT] = {
-    "Classic Bars",
-    "Waterfall",
-    "Radial",
-    "Mirror Mode"
-};
-
 // ============================================================================
 // Private Helpers
 // ============================================================================
 
+/**
+ * @brief Fill a rectangle given in screen coordinates
+ * 
+ * Under a hardware scroll the rectangle is moved along the scroll axis to
+ * where it currently shows up (split in two where it wraps), so it stays
+ * put on screen. Unscrolled this is a plain fill.
+ */
+static void fill_screen_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    bool horizontal = ili9341_scroll_is_horizontal();
+    int16_t start = horizontal ? x : y;
+    int16_t length = horizontal ? w : h;
+    
+    // Mapping is a rotation, so only the first coordinate needs converting
+    int16_t pos = (int16_t)ili9341_scroll_screen_coord((uint16_t)start);
+    int16_t first = MIN(length, ILI9341_TFTHEIGHT - pos);
+    
+    if (horizontal) {
+        strip_renderer_fill_rect(pos, y, first, h, color);
+        if (first < length) strip_renderer_fill_rect(0, y, length - first, h, color);
+    } else {
+        strip_renderer_fill_rect(x, pos, w, first, color);
+        if (first < length) strip_renderer_fill_rect(x, 0, w, length - first, color);
+    }
+}
+
 /**
  * @brief Draw theme name overlay
+ * 
+ * Drawn in screen coordinates, so it holds still over a scrolling theme.
  */
 static void draw_overlay(void) {
-    const char* name = _theme_names[_current_theme];
+    const char* name = _themes[_current_theme]->name;
     
     // Calculate text dimensions (rough estimate)
     uint16_t text_len = 0;
@@ -49,21 +83,22 @@ static void draw_overlay(void) {
     
     // Draw semi-transparent background (black rectangle)
     uint16_t bg_padding = 10;
-    ili9341_fill_rect(x - bg_padding, y - bg_padding, 
-                      text_width + 2 * bg_padding, 
-                      text_height + 2 * bg_padding, 
-                      ILI9341_BLACK);
+    int16_t box_x = x - bg_padding;
+    int16_t box_y = y - bg_padding;
+    int16_t box_w = text_width + 2 * bg_padding;
+    int16_t box_h = text_height + 2 * bg_padding;
+    fill_screen_rect(box_x, box_y, box_w, box_h, ILI9341_BLACK);
     
     // Draw border
-    ili9341_draw_rect(x - bg_padding, y - bg_padding,
-                      text_width + 2 * bg_padding,
-                      text_height + 2 * bg_padding,
-                      ILI9341_WHITE);
+    fill_screen_rect(box_x, box_y, box_w, 1, ILI9341_WHITE);
+    fill_screen_rect(box_x, box_y + box_h - 1, box_w, 1, ILI9341_WHITE);
+    fill_screen_rect(box_x, box_y, 1, box_h, ILI9341_WHITE);
+    fill_screen_rect(box_x + box_w - 1, box_y, 1, box_h, ILI9341_WHITE);
     
     // Draw text (simple implementation - could be enhanced)
     // For now, just draw a filled rectangle as placeholder
     // In a full implementation, you'd use a font rendering library
-    ili9341_fill_rect(x, y, text_width, 2, ILI9341_CYAN);
+    fill_screen_rect(x, y, text_width, 2, ILI9341_CYAN);
 }
 
 // ============================================================================
@@ -74,13 +109,21 @@ void theme_manager_init(void) {
     _current_theme = THEME_BARS;
     _overlay_visible = false;
     
-    // Initialize all themes
-    bars_init();
-    waterfall_init();
-    radial_init();
-    mirror_init();
+    // Shared rendering backend (display size is fixed by now)
+    ili9341_scroll_reset();
+    strip_renderer_init();
+    palette_init();
     
-    DEBUG_PRINTF("Theme manager initialized (default: %s)\n", _theme_names[_current_theme]);
+    // Initialize all themes (once; they keep their state while hidden)
+    for (uint8_t i = 0; i < THEME_COUNT; i++) {
+        _themes[i]->init();
+        profiler_name_theme(i, _themes[i]->name);
+    }
+    if (_themes[_current_theme]->resume) {
+        _themes[_current_theme]->resume();
+    }
+    
+    DEBUG_PRINTF("Theme manager initialized (default: %s)\n", _themes[_current_theme]->name);
 }
 
 theme_type_t theme_manager_get_current(void) {
@@ -91,30 +134,22 @@ void theme_manager_set_theme(theme_type_t theme) {
     if (theme >= THEME_COUNT) return;
     
     if (_current_theme != theme) {
-        _current_theme = theme;
+        const theme_t *old = _themes[_current_theme];
+        const theme_t *next = _themes[theme];
         
-        // Clear the display for the new theme
-        ili9341_fill_screen(ILI9341_BLACK);
+        if (old->suspend) old->suspend();
+        _current_theme = theme;
+        if (next->resume) next->resume();
         
-        // Reinitialize the new theme
-        switch (theme) {
-            case THEME_BARS:
-                bars_init();
-                break;
-            case THEME_WATERFALL:
-                waterfall_init();
-                break;
-            case THEME_RADIAL:
-                radial_init();
-                break;
-            case THEME_MIRROR:
-                mirror_init();
-                break;
-            default:
-                break;
+        // An opaque theme repaints every pixel from its own state in one
+        // pass; others start from a DMA clear and only draw what they cover
+        if (next->opaque) {
+            strip_renderer_invalidate();
+        } else {
+            strip_renderer_clear(ILI9341_BLACK);
         }
         
-        DEBUG_PRINTF("Switched to theme: %s\n", _theme_names[theme]);
+        DEBUG_PRINTF("Switched to theme: %s\n", next->name);
         
         // Show theme name for 2 seconds
         theme_manager_show_name(2000);
@@ -132,34 +167,33 @@ void theme_manager_prev(void) {
 }
 
 const char* theme_manager_get_name(void) {
-    return _theme_names[_current_theme];
+    return _themes[_current_theme]->name;
 }
 
-void theme_manager_render(const float *bands, uint8_t num_bands) {
-    if (!bands || num_bands == 0) return;
+void theme_manager_render(const uint16_t *levels, const uint16_t *peaks, uint8_t num_bands) {
+    if (!levels || !peaks || num_bands == 0) return;
+    
+    PROFILE_BEGIN(theme);
+    
+    // Themes add primitives; the changed strips go out at the end
+    strip_renderer_begin_frame(ILI9341_BLACK);
     
     // Render current theme
-    switch (_current_theme) {
-        case THEME_BARS:
-            bars_render(bands, num_bands);
-            break;
-        case THEME_WATERFALL:
-            waterfall_render(bands, num_bands);
-            break;
-        case THEME_RADIAL:
-            radial_render(bands, num_bands);
-            break;
-        case THEME_MIRROR:
-            mirror_render(bands, num_bands);
-            break;
-        default:
-            break;
-    }
+    _themes[_current_theme]->render(levels, peaks, num_bands);
     
     // Draw overlay if visible
     if (_overlay_visible) {
         draw_overlay();
     }
+    PROFILE_END(theme, PROF_RENDER);
+    
+    // One bus transaction per frame (CS stays asserted between strips)
+    PROFILE_BEGIN(transfer);
+    ili9341_begin_transaction();
+    strip_renderer_end_frame();
+    ili9341_end_transaction();
+    PROFILE_END(transfer, PROF_TRANSFER);
+    PROFILE_END_THEME(theme, _current_theme);
 }
 
 void theme_manager_show_name(uint32_t duration_ms) {
@@ -4,50 +4,51 @@
  * 
  * Features:
  * - Vertical bars for each frequency band
- * - Color gradient: green → yellow → red based on amplitude
+ * - Color gradient: green → yellow → red based on amplitude (PALETTE_LEVEL)
  * - Peak hold indicators
- * - Smooth animations with decay
+ * 
+ * Smoothing and peak hold come with the levels (audio/band_dynamics).
  */
 
 #include "display/themes/bars.h"
 #include "display/ili9341.h"
+#include "display/strip_renderer.h"
+#include "display/palette.h"
 #include "config.h"
-#include <string.h>
 
 // ============================================================================
 // Private State
 // ============================================================================
 
-#define MAX_BANDS 32
+#define MAX_BANDS BAND_COUNT_MAX
 
-static float _current_levels[MAX_BANDS] = {0};
-static float _peak_levels[MAX_BANDS] = {0};
-static uint32_t _peak_hold_time[MAX_BANDS] = {0};
+// Levels are Q8.8 palette levels (0 to 255.996 as 0 to 65535)
+#define PEAK_MIN_LEVEL  3277    // ~0.05 of full scale, peak indicator shown above
 
-// ============================================================================
-// Color Gradient
-// ============================================================================
+static const uint16_t *_palette = NULL;
+
+// Bar colour by distance from the bar bottom, constant within each segment;
+// fixed per row so a bar that moves only repaints the rows in between
+#define SEGMENT_HEIGHT  10
+#define MAX_BAR_ROWS    MAX(DISPLAY_WIDTH, DISPLAY_HEIGHT)  // Either rotation
+
+static uint16_t _segment_colors[MAX_BAR_ROWS];
+static uint16_t _segment_rows = 0;     // Bar height the table was built for
 
 /**
- * @brief Calculate color based on amplitude (0.0 to 1.0)
- * Green (low) → Yellow (mid) → Red (high)
+ * @brief Build the segment colour table for the given maximum bar height
  */
-static uint16_t get_amplitude_color(float amplitude) {
-    if (amplitude < 0.5f) {
-        // Green to Yellow: 0.0 - 0.5
-        float t = amplitude * 2.0f;  // 0.0 to 1.0
-        uint8_t r = (uint8_t)(t * 255.0f);
-        uint8_t g = 255;
-        uint8_t b = 0;
-        return RGB565(r, g, b);
-    } else {
-        // Yellow to Red: 0.5 - 1.0
-        float t = (amplitude - 0.5f) * 2.0f;  // 0.0 to 1.0
-        uint8_t r = 255;
-        uint8_t g = (uint8_t)((1.0f - t) * 255.0f);
-        uint8_t b = 0;
-        return RGB565(r, g, b);
+static void build_segment_colors(uint16_t bar_max_height) {
+    for (uint16_t row = 0; row < bar_max_height; row++) {
+        // Each segment takes the colour of the level at its top
+        uint32_t seg_top = (row / SEGMENT_HEIGHT + 1) * SEGMENT_HEIGHT;
+        uint32_t level = seg_top * (PALETTE_SIZE - 1) / bar_max_height;
+        _segment_colors[row] = _palette[MIN(level, PALETTE_SIZE - 1)];
     }
+    _segment_rows = bar_max_height;
+    
+    // Bars already on screen used the old table
+    strip_renderer_invalidate();
 }
 
 // ============================================================================
@@ -55,14 +56,12 @@ static uint16_t get_amplitude_color(float amplitude) {
 // ============================================================================
 
 void bars_init(void) {
-    // Reset state
-    memset(_current_levels, 0, sizeof(_current_levels));
-    memset(_peak_levels, 0, sizeof(_peak_levels));
-    memset(_peak_hold_time, 0, sizeof(_peak_hold_time));
+    _palette = palette_get(PALETTE_LEVEL);
+    _segment_rows = 0;
 }
 
-void bars_render(const float *bands, uint8_t num_bands) {
-    if (!bands || num_bands == 0 || num_bands > MAX_BANDS) return;
+void bars_render(const uint16_t *levels, const uint16_t *peaks, uint8_t num_bands) {
+    if (!levels || !peaks || num_bands == 0 || num_bands > MAX_BANDS) return;
     
     uint16_t display_width = ili9341_width();
     uint16_t display_height = ili9341_height();
@@ -74,90 +73,49 @@ void bars_render(const float *bands, uint8_t num_bands) {
     uint16_t bar_max_height = display_height - 40;  // Leave room for margins
     uint16_t bar_bottom = display_height - 10;
     
-    // Smoothing factor for animations
-    const float smooth_up = 0.3f;    // Fast rise
-    const float smooth_down = 0.85f;  // Slower decay
-    const float peak_decay = 0.99f;   // Very slow peak decay
-    const uint32_t peak_hold_frames = 20;  // Hold peak for 20 frames (~0.67s at 30fps)
+    if (bar_max_height != _segment_rows) {
+        build_segment_colors(bar_max_height);
+    }
     
-    // Process each band
+    // Draw each band
     for (uint8_t i = 0; i < num_bands; i++) {
-        // Smooth the input value
-        float target_level = bands[i];
-        if (target_level > _current_levels[i]) {
-            // Quick rise
-            _current_levels[i] += (target_level - _current_levels[i]) * smooth_up;
-        } else {
-            // Slower decay
-            _current_levels[i] *= smooth_down;
-        }
-        
-        // Clamp to 0-1
-        if (_current_levels[i] < 0.01f) _current_levels[i] = 0.0f;
-        if (_current_levels[i] > 1.0f) _current_levels[i] = 1.0f;
-        
-        // Update peak hold
-        if (_current_levels[i] > _peak_levels[i]) {
-            _peak_levels[i] = _current_levels[i];
-            _peak_hold_time[i] = peak_hold_frames;
-        } else {
-            // Decay peak
-            if (_peak_hold_time[i] > 0) {
-                _peak_hold_time[i]--;
-            } else {
-                _peak_levels[i] *= peak_decay;
-                if (_peak_levels[i] < 0.01f) _peak_levels[i] = 0.0f;
-            }
-        }
-        
         // Calculate bar position
         uint16_t bar_x = 10 + i * (bar_width + bar_spacing);
         
         // Calculate bar height based on level
-        uint16_t bar_height = (uint16_t)(_current_levels[i] * bar_max_height);
+        uint16_t bar_height = (uint16_t)(((uint32_t)levels[i] * bar_max_height) >> 16);
         uint16_t bar_y = bar_bottom - bar_height;
         
-        // Clear the column (draw background)
-        ili9341_fill_rect(bar_x, 10, bar_width, bar_max_height, ILI9341_BLACK);
-        
-        // Draw the bar with color gradient
-        if (bar_height > 0) {
-            // Draw bar in segments for gradient effect
-            const uint16_t segment_height = 10;
-            uint16_t segments = (bar_height + segment_height - 1) / segment_height;
-            
-            for (uint16_t seg = 0; seg < segments; seg++) {
-                uint16_t seg_y = bar_bottom - (seg + 1) * segment_height;
-                uint16_t seg_h = segment_height;
-                
-                // Adjust last segment
-                if (seg == segments - 1) {
-                    seg_h = bar_height - seg * segment_height;
-                    seg_y = bar_y;
-                }
-                
-                // Calculate color for this segment
-                float seg_amplitude = (float)(seg + 1) / segments * _current_levels[i];
-                uint16_t seg_color = get_amplitude_color(seg_amplitude);
-                
-                ili9341_fill_rect(bar_x, seg_y, bar_width, seg_h, seg_color);
-            }
-        }
+        // Draw the bar with the segment colours; it is always added (even
+        // when empty) so the renderer only repaints the rows that changed
+        strip_renderer_gradient(bar_x, bar_y, bar_width, bar_height,
+                                _segment_colors, bar_bottom - 1, GRADIENT_UP);
         
-        // Draw peak hold indicator
-        if (_peak_levels[i] > 0.05f) {
-            uint16_t peak_y = bar_bottom - (uint16_t)(_peak_levels[i] * bar_max_height);
-            uint16_t peak_color = get_amplitude_color(_peak_levels[i]);
-            ili9341_fill_rect(bar_x, peak_y, bar_width, 2, peak_color);
-        }
+        // Draw peak hold indicator (an empty rect while hidden)
+        uint16_t peak_y = bar_bottom - (uint16_t)(((uint32_t)peaks[i] * bar_max_height) >> 16);
+        uint16_t peak_color = _palette[peaks[i] >> 8];
+        bool show_peak = peaks[i] > PEAK_MIN_LEVEL;
+        strip_renderer_fill_rect(bar_x, peak_y, bar_width, show_peak ? 2 : 0, peak_color);
     }
 }
 
 void bars_clear(void) {
-    // Fill screen with background color
-    ili9341_fill_screen(ILI9341_BLACK);
+    // Repaint the whole screen on the next frame
+    strip_renderer_invalidate();
     
     // Reset internal state
     bars_init();
 }
 
+// ============================================================================
+// Theme Table
+// ============================================================================
+
+const theme_t bars_theme = {
+    .name = "Classic Bars",
+    .init = bars_init,
+    .render = bars_render,
+    .resume = NULL,
+    .suspend = NULL,
+    .opaque = false,
+};
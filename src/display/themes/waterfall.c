@@ -3,11 +3,25 @@
  * @brief Waterfall spectrogram implementation
  * 
  * Displays spectrum as scrolling color-coded history.
- * Each new frame is drawn at the top and scrolls down.
+ * 
+ * Uses the ILI9341 hardware scroll: each frame writes only the newest line
+ * into frame memory and moves the scroll start past it, so the oldest line
+ * is shown first. The scroll axis is the panel's 320-line axis, which is
+ * horizontal in landscape (bands then run bottom to top) and vertical in
+ * portrait (bands left to right).
+ * 
+ * The history is kept while other themes are shown, so switching back
+ * repaints it in one pass and the scroll continues where it stopped.
+ * 
+ * The theme-name overlay is pinned to the screen (theme_manager maps it
+ * through the scroll), so it never sits on the newest line, which is
+ * always shown at the edge of the scroll axis.
  */
 
 #include "display/themes/waterfall.h"
 #include "display/ili9341.h"
+#include "display/strip_renderer.h"
+#include "display/palette.h"
 #include "config.h"
 #include <string.h>
 
@@ -15,55 +29,54 @@
 // Configuration
 // ============================================================================
 
-#define MAX_BANDS 32
-#define HISTORY_HEIGHT 200  // Number of rows of history to keep
+#define MAX_BANDS BAND_COUNT_MAX
+#define SCROLL_LINES ILI9341_TFTHEIGHT  // History lines (whole scroll axis)
+#define CROSS_PIXELS ILI9341_TFTWIDTH   // Pixels across the scroll axis
 
 // ============================================================================
 // Private State
 // ============================================================================
 
-static uint16_t _history_buffer[HISTORY_HEIGHT][MAX_BANDS];
-static uint8_t _current_row = 0;
+// Band levels per frame-memory line (only read to repaint the screen)
+static uint8_t _history_buffer[SCROLL_LINES][MAX_BANDS];
+static uint16_t _write_line = 0;   // Frame-memory line for the next frame
 static uint8_t _num_bands = 0;
+static uint16_t _band_size = 1;    // Pixels per band across the scroll axis
+static uint16_t _version = 0;      // Bumped when the whole history must be repainted
+
+static uint16_t _line_pixels[CROSS_PIXELS];  // Newest line (DMA source)
+static const uint16_t *_palette = NULL;      // Blue → cyan → green → yellow → red heat map
 
 // ============================================================================
-// Color Mapping
+// Line Rendering
 // ============================================================================
 
 /**
- * @brief Convert amplitude to color (blue → cyan → green → yellow → red)
- * Creates a "heat map" effect
+ * @brief Colour at position p across the scroll axis for one history line
  */
-static uint16_t amplitude_to_color(float amplitude) {
-    if (amplitude < 0.0f) amplitude = 0.0f;
-    if (amplitude > 1.0f) amplitude = 1.0f;
-    
-    // Color gradient: Black → Blue → Cyan → Green → Yellow → Red
-    if (amplitude < 0.2f) {
-        // Black to Blue
-        float t = amplitude / 0.2f;
-        uint8_t b = (uint8_t)(t * 255.0f);
-        return RGB565(0, 0, b);
-    } else if (amplitude < 0.4f) {
-        // Blue to Cyan
-        float t = (amplitude - 0.2f) / 0.2f;
-        uint8_t g = (uint8_t)(t * 255.0f);
-        return RGB565(0, g, 255);
-    } else if (amplitude < 0.6f) {
-        // Cyan to Green
-        float t = (amplitude - 0.4f) / 0.2f;
-        uint8_t b = (uint8_t)((1.0f - t) * 255.0f);
-        return RGB565(0, 255, b);
-    } else if (amplitude < 0.8f) {
-        // Green to Yellow
-        float t = (amplitude - 0.6f) / 0.2f;
-        uint8_t r = (uint8_t)(t * 255.0f);
-        return RGB565(r, 255, 0);
+static inline uint16_t band_color(const uint8_t *line, uint16_t p) {
+    uint16_t band = p / _band_size;
+    return (band < _num_bands) ? _palette[line[band]] : ILI9341_BLACK;
+}
+
+/**
+ * @brief Produce one screen row of history for the strip renderer
+ * 
+ * Works in frame-memory coordinates, so repaints are correct at any
+ * scroll position.
+ */
+static void draw_history_row(int16_t y, int16_t x, uint16_t count, uint16_t *pixels) {
+    if (ili9341_scroll_is_horizontal()) {
+        // Each screen column is one history line, bands run bottom to top
+        uint16_t p = CROSS_PIXELS - 1 - y;
+        for (uint16_t i = 0; i < count; i++) {
+            pixels[i] = band_color(_history_buffer[ili9341_scroll_line_coord(x + i)], p);
+        }
     } else {
-        // Yellow to Red
-        float t = (amplitude - 0.8f) / 0.2f;
-        uint8_t g = (uint8_t)((1.0f - t) * 255.0f);
-        return RGB565(255, g, 0);
+        const uint8_t *line = _history_buffer[ili9341_scroll_line_coord(y)];
+        for (uint16_t i = 0; i < count; i++) {
+            pixels[i] = band_color(line, x + i);
+        }
     }
 }
 
@@ -73,51 +86,89 @@ static uint16_t amplitude_to_color(float amplitude) {
 
 void waterfall_init(void) {
     memset(_history_buffer, 0, sizeof(_history_buffer));
-    _current_row = 0;
+    _write_line = 0;
     _num_bands = 0;
+    _band_size = 1;
+    _version++;
+    _palette = palette_get(PALETTE_HEAT);
 }
 
-void waterfall_render(const float *bands, uint8_t num_bands) {
-    if (!bands || num_bands == 0 || num_bands > MAX_BANDS) return;
+void waterfall_render(const uint16_t *levels, const uint16_t *peaks, uint8_t num_bands) {
+    (void)peaks;
+    if (!levels || num_bands == 0 || num_bands > MAX_BANDS) return;
     
-    _num_bands = num_bands;
+    if (num_bands != _num_bands) {
+        // New band layout: repaint the history with it
+        _num_bands = num_bands;
+        _band_size = CROSS_PIXELS / num_bands;
+        _version++;
+    }
     
-    uint16_t display_width = ili9341_width();
-    uint16_t display_height = ili9341_height();
+    // Store new data in history buffer, at the line it occupies on the panel
+    uint8_t *line = _history_buffer[_write_line];
+    for (uint8_t i = 0; i < num_bands; i++) {
+        line[i] = (uint8_t)(levels[i] >> 8);
+    }
     
-    // Calculate band width
-    uint16_t band_width = display_width / num_bands;
+    // Previous line may still be on the wire
+    ili9341_wait();
     
-    // Store new data in history buffer
-    for (uint8_t i = 0; i < num_bands; i++) {
-        uint16_t color = amplitude_to_color(bands[i]);
-        _history_buffer[_current_row][i] = color;
+    bool horizontal = ili9341_scroll_is_horizontal();
+    for (uint16_t p = 0; p < CROSS_PIXELS; p++) {
+        _line_pixels[horizontal ? (CROSS_PIXELS - 1 - p) : p] = band_color(line, p);
     }
     
-    // Scroll display: draw history from oldest to newest
-    uint16_t y = 0;
-    for (uint16_t row = 0; row < HISTORY_HEIGHT && y < display_height; row++) {
-        // Calculate which history row to draw (wrap around circular buffer)
-        uint16_t history_idx = (_current_row + 1 + row) % HISTORY_HEIGHT;
-        
-        // Draw each band for this row
-        for (uint8_t band = 0; band < num_bands; band++) {
-            uint16_t x = band * band_width;
-            uint16_t color = _history_buffer[history_idx][band];
-            
-            // Draw a single pixel row (or small rectangle for visibility)
-            ili9341_fill_rect(x, y, band_width, 1, color);
-        }
-        
-        y++;
+    // Start the display right after the new line, so the oldest line comes
+    // first. Sent before the line goes out: commands wait for the bus, and
+    // this way nothing waits for the line itself.
+    uint16_t next_line = (_write_line + 1) % SCROLL_LINES;
+    ili9341_scroll_to(next_line);
+    
+    // Write only the newest line
+    int16_t pos = (int16_t)ili9341_scroll_line_coord(_write_line);
+    if (horizontal) {
+        ili9341_blit_async(pos, 0, 1, CROSS_PIXELS, _line_pixels);
+    } else {
+        ili9341_blit_async(0, pos, CROSS_PIXELS, 1, _line_pixels);
     }
+    _write_line = next_line;
     
-    // Advance to next row
-    _current_row = (_current_row + 1) % HISTORY_HEIGHT;
+    // Whole history for repaints (theme switch, overlay); the version only
+    // changes when it has to be redrawn, so normally nothing else is sent
+    strip_renderer_rows(0, 0, ili9341_width(), ili9341_height(), draw_history_row, _version);
 }
 
 void waterfall_clear(void) {
-    ili9341_fill_screen(ILI9341_BLACK);
+    ili9341_scroll_reset();
+    strip_renderer_invalidate();
     waterfall_init();
 }
 
+// ============================================================================
+// Theme Table
+// ============================================================================
+
+/**
+ * @brief Back on screen: continue the scroll where it stopped and repaint
+ *        the retained history
+ */
+static void waterfall_resume(void) {
+    ili9341_scroll_to(_write_line);
+    _version++;
+}
+
+/**
+ * @brief Other themes draw unscrolled; the history stays for the next resume
+ */
+static void waterfall_suspend(void) {
+    ili9341_scroll_reset();
+}
+
+const theme_t waterfall_theme = {
+    .name = "Waterfall",
+    .init = waterfall_init,
+    .render = waterfall_render,
+    .resume = waterfall_resume,
+    .suspend = waterfall_suspend,
+    .opaque = true,
+};
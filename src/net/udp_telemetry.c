@@ -0,0 +1,277 @@
+/**
+ * @file udp_telemetry.c
+ * @brief Wi-Fi UDP telemetry implementation
+ * 
+ * Polled CYW43 + lwIP (pico_cyw43_arch_lwip_poll): the driver, lwIP timers
+ * and every send run inside udp_telemetry_service() on the display core, so
+ * no network code ever runs on the audio core or in its interrupts.
+ * 
+ * Each datagram is built directly in a pre-allocated PBUF_RAM pbuf. lwIP
+ * adds its headers in the pbuf's reserved headroom while sending, so the
+ * payload pointer is restored to its allocation position before the pbuf
+ * is reused. A pbuf whose reference count is above one is still queued
+ * inside lwIP (e.g. waiting for ARP); the batch that would need it is
+ * dropped instead of waiting.
+ */
+
+#include "net/udp_telemetry.h"
+#include "config.h"
+
+#if WIFI_TELEMETRY_ENABLE
+
+#include "utils/spectrum_stream.h"
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/ip_addr.h"
+#include "lwip/netif.h"
+#include <stdio.h>
+#include <string.h>
+
+#define DATAGRAM_BYTES \
+    STREAM_PACKET_BYTES(TELEMETRY_BATCH_FRAMES * STREAM_BAND_RECORD_BYTES(BAND_COUNT_MAX, 1))
+#define FRAME_PERIOD_US (1000000 / TELEMETRY_FRAME_RATE_HZ)
+
+_Static_assert(TELEMETRY_BATCH_FRAMES >= 1 && TELEMETRY_BATCH_FRAMES <= 255,
+               "TELEMETRY_BATCH_FRAMES must fit the record count");
+
+typedef enum {
+    NET_DOWN,       // Waiting to (re)join
+    NET_JOINING,    // Join and DHCP in progress
+    NET_UP          // Address assigned, sending
+} net_state_t;
+
+// ============================================================================
+// Private State (display core only)
+// ============================================================================
+
+static bool _initialized = false;
+static net_state_t _state = NET_DOWN;
+static uint64_t _retry_at_us = 0;
+static struct udp_pcb *_pcb = NULL;
+static ip_addr_t _target;
+
+// Datagram pbufs, used round robin
+static struct pbuf *_pbufs[TELEMETRY_PBUF_COUNT];
+static uint8_t *_pbuf_data[TELEMETRY_PBUF_COUNT];  // Payload position at allocation
+static uint8_t _next_pbuf = 0;
+
+// Batch being filled (NULL if none)
+static struct pbuf *_batch = NULL;
+static uint8_t _batch_records = 0;
+static uint32_t _batch_bytes = 0;
+static uint16_t _sequence = 0;
+static uint32_t _dropped = 0;
+
+// Newest displayed frame and the sampling grid
+static float _offered[BAND_COUNT_MAX];
+static uint8_t _offered_bands = 0;
+static bool _offered_new = false;
+static uint64_t _next_frame_us = 0;
+
+// ============================================================================
+// Private Functions
+// ============================================================================
+
+static void start_join(uint64_t now) {
+    uint32_t auth = WIFI_PASSWORD[0] ? CYW43_AUTH_WPA2_AES_PSK : CYW43_AUTH_OPEN;
+    if (cyw43_arch_wifi_connect_async(WIFI_SSID, WIFI_PASSWORD, auth) != 0) {
+        printf("WARNING: Wi-Fi join of \"%s\" failed to start\n", WIFI_SSID);
+        _retry_at_us = now + TELEMETRY_RETRY_MS * 1000ull;
+        return;
+    }
+    _state = NET_JOINING;
+}
+
+/**
+ * @brief Abandon the open batch (link lost); its pbuf goes back to the pool
+ */
+static void discard_batch(void) {
+    _batch = NULL;
+    _batch_records = 0;
+    _batch_bytes = 0;
+}
+
+static void update_link(uint64_t now) {
+    int status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+    
+    switch (_state) {
+        case NET_DOWN:
+            if (now >= _retry_at_us) start_join(now);
+            break;
+        case NET_JOINING:
+            if (status == CYW43_LINK_UP) {
+                _state = NET_UP;
+                _next_frame_us = now;
+                printf("Wi-Fi: %s up, telemetry to %s:%d\n",
+                       ip4addr_ntoa(netif_ip4_addr(netif_default)), TELEMETRY_TARGET_IP,
+                       TELEMETRY_PORT);
+            } else if (status < 0) {
+                printf("WARNING: Wi-Fi join of \"%s\" failed (%d), retrying in %d s\n",
+                       WIFI_SSID, status, TELEMETRY_RETRY_MS / 1000);
+                _state = NET_DOWN;
+                _retry_at_us = now + TELEMETRY_RETRY_MS * 1000ull;
+            }
+            break;
+        case NET_UP:
+            if (status != CYW43_LINK_UP) {
+                printf("WARNING: Wi-Fi link lost (%d), rejoining\n", status);
+                discard_batch();
+                _state = NET_DOWN;
+                _retry_at_us = now;
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Claim the next pbuf for a batch, or NULL if lwIP still holds it
+ */
+static struct pbuf *open_batch(void) {
+    uint8_t index = _next_pbuf;
+    struct pbuf *p = _pbufs[index];
+    if (p->ref > 1) return NULL;
+    
+    // Undo the headers lwIP prepended during the last send
+    uint8_t *payload = (uint8_t *)p->payload;
+    if (payload != _pbuf_data[index]) {
+        pbuf_remove_header(p, (size_t)(_pbuf_data[index] - payload));
+    }
+    
+    _next_pbuf = (uint8_t)((index + 1) % TELEMETRY_PBUF_COUNT);
+    _batch_records = 0;
+    _batch_bytes = 0;
+    return p;
+}
+
+static void send_batch(void) {
+    struct pbuf *p = _batch;
+    uint32_t length = spectrum_stream_seal_packet((uint8_t *)p->payload, STREAM_PACKET_BANDS8,
+                                                  _batch_records, _sequence++, _batch_bytes);
+    
+    // Single PBUF_RAM pbuf allocated at DATAGRAM_BYTES: trim to this batch
+    p->len = (u16_t)length;
+    p->tot_len = (u16_t)length;
+    
+    cyw43_arch_lwip_begin();
+    err_t err = udp_sendto(_pcb, p, &_target, TELEMETRY_PORT);
+    cyw43_arch_lwip_end();
+    if (err != ERR_OK) {
+        _dropped += _batch_records;
+    }
+    discard_batch();
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool udp_telemetry_init(void) {
+    if (_initialized) return true;
+    
+    if (!ipaddr_aton(TELEMETRY_TARGET_IP, &_target)) {
+        printf("ERROR: Bad TELEMETRY_TARGET_IP \"%s\"\n", TELEMETRY_TARGET_IP);
+        return false;
+    }
+    if (cyw43_arch_init() != 0) {
+        printf("ERROR: CYW43 wireless init failed\n");
+        return false;
+    }
+    cyw43_arch_enable_sta_mode();
+    
+    // Everything the send path needs, allocated once
+    _pcb = udp_new_ip_type(IPADDR_TYPE_V4);
+    for (uint8_t i = 0; i < TELEMETRY_PBUF_COUNT; i++) {
+        _pbufs[i] = _pcb ? pbuf_alloc(PBUF_TRANSPORT, DATAGRAM_BYTES, PBUF_RAM) : NULL;
+        if (!_pbufs[i]) {
+            printf("ERROR: Telemetry buffer allocation failed (raise MEM_SIZE)\n");
+            cyw43_arch_deinit();
+            return false;
+        }
+        _pbuf_data[i] = (uint8_t *)_pbufs[i]->payload;
+    }
+    
+    _state = NET_DOWN;
+    _retry_at_us = 0;
+    _initialized = true;
+    
+    DEBUG_PRINTF("UDP telemetry: \"%s\" -> %s:%d, %d frames/s, %d per datagram\n",
+                 WIFI_SSID, TELEMETRY_TARGET_IP, TELEMETRY_PORT,
+                 TELEMETRY_FRAME_RATE_HZ, TELEMETRY_BATCH_FRAMES);
+    return true;
+}
+
+void udp_telemetry_offer(const float *bands, uint8_t num_bands) {
+    if (!_initialized || !bands || num_bands == 0 || num_bands > BAND_COUNT_MAX) return;
+    
+    memcpy(_offered, bands, num_bands * sizeof(float));
+    _offered_bands = num_bands;
+    _offered_new = true;
+}
+
+bool udp_telemetry_service(void) {
+    if (!_initialized) return false;
+    
+    // Driver events and lwIP timers (DHCP, ARP)
+    cyw43_arch_poll();
+    
+    uint64_t now = time_us_64();
+    update_link(now);
+    if (_state != NET_UP || now < _next_frame_us) return false;
+    
+    // Fixed sampling grid; slots missed while busy are skipped
+    _next_frame_us += FRAME_PERIOD_US;
+    if (_next_frame_us <= now) _next_frame_us = now + FRAME_PERIOD_US;
+    if (!_offered_new) return false;
+    _offered_new = false;
+    
+    if (!_batch) {
+        _batch = open_batch();
+        if (!_batch) {
+            _dropped++;
+            return true;
+        }
+    }
+    
+    uint8_t *record = (uint8_t *)_batch->payload + STREAM_HEADER_BYTES + _batch_bytes;
+    _batch_bytes += spectrum_stream_encode_bands(record, STREAM_PACKET_BANDS8, _offered,
+                                                 _offered_bands, (uint32_t)now);
+    if (++_batch_records < TELEMETRY_BATCH_FRAMES) return false;
+    
+    send_batch();
+    return true;
+}
+
+bool udp_telemetry_connected(void) {
+    return _state == NET_UP;
+}
+
+uint32_t udp_telemetry_dropped(void) {
+    return _dropped;
+}
+
+#else // !WIFI_TELEMETRY_ENABLE
+
+bool udp_telemetry_init(void) {
+    return false;
+}
+
+void udp_telemetry_offer(const float *bands, uint8_t num_bands) {
+    (void)bands;
+    (void)num_bands;
+}
+
+bool udp_telemetry_service(void) {
+    return false;
+}
+
+bool udp_telemetry_connected(void) {
+    return false;
+}
+
+uint32_t udp_telemetry_dropped(void) {
+    return 0;
+}
+
+#endif // WIFI_TELEMETRY_ENABLE
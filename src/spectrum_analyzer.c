@@ -4,53 +4,445 @@
  * 
  * Captures audio from MAX4466 microphone, performs FFT,
  * displays spectrum on ILI9341 display with touch-controlled themes.
+ * 
+ * Runs as a two-stage pipeline:
+ * - Core 0 (CORE_AUDIO): ADC capture, framing, FFT, band extraction and
+ *   band dynamics (smoothing, peak hold, AGC)
+ * - Core 1 (CORE_DISPLAY): touch input, theme rendering, ILI9341 output
+ * Band results cross between the cores through a latest-wins triple buffer,
+ * so FFT throughput and display frame rate are independent.
+ * 
+ * Low bands can come from extra FFTs of decimated input (multirate
+ * analysis), or all bands from a constant-Q filter bank instead of the
+ * FFT. FFT size, sample rate, multirate and the band engine can be
+ * changed while running (long press or serial commands); core 1 posts the
+ * request and core 0 applies it between hops.
+ * 
+ * The input can be recorded to flash and replayed in place of the ADC
+ * (audio/sample_source.h), in real time or at maximum speed as an
+ * on-target throughput benchmark.
  */
 
 #include <stdio.h>
+#include <stdarg.h>
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
 #include "display/ili9341.h"
 #include "display/theme_manager.h"
 #include "touch/xpt2046.h"
 #include "audio/adc_sampler.h"
+#include "audio/stft_framer.h"
+#include "audio/multirate.h"
 #include "audio/fft_processor.h"
+#include "audio/filter_bank.h"
+#include "audio/band_dynamics.h"
+#include "audio/sample_source.h"
+#include "net/udp_telemetry.h"
+#include "utils/band_buffer.h"
+#include "utils/profiler.h"
+#include "utils/scheduler.h"
+#include "utils/spectrum_stream.h"
 #include "config.h"
 
 // ============================================================================
 // Configuration
 // ============================================================================
 
-#define NUM_BANDS 16        // Number of frequency bands to display
+#define NUM_BANDS BAND_COUNT_DEFAULT  // Frequency bands extracted and displayed
 #define TARGET_FPS 30       // Target frames per second
 #define FRAME_TIME_US (1000000 / TARGET_FPS)
+#define UI_PERIOD_US 10000  // Touch gestures and serial commands
+#define STREAM_PERIOD_US 1000  // USB stream drain (one CDC buffer per run at most)
+#define NET_PERIOD_US 2000     // CYW43/lwIP poll and UDP telemetry
+#define STATS_PERIOD_US 5000000
 
 // ============================================================================
-// Main
+// Shared State
 // ============================================================================
 
-int main(void) {
-    // Initialize stdio - wait for USB
-    stdio_init_all();
-    sleep_ms(2000);
+// Written by core 0 only, read by core 1 for statistics
+static volatile uint32_t _fft_failures = 0;
+
+// One task scheduler per core, each only run by its own core
+static scheduler_t _audio_sched;
+static scheduler_t _display_sched;
+static sched_task_t *_render_task = NULL;
+
+// Analysis settings as (sample rate << 16) | (engine << 15) | (levels << 12)
+// | FFT size. Core 1 writes the request, core 0 applies it and then
+// updates the active value.
+#define ANALYSIS_CONFIG(size, rate, levels, engine) \
+    (((uint32_t)(rate) << 16) | ((uint32_t)(engine) << 15) | \
+     ((uint32_t)(levels) << 12) | (uint32_t)(size))
+#define CONFIG_SIZE(config)         ((config) & 0x0FFF)
+#define CONFIG_LEVELS(config)       (((config) >> 12) & 0x7)
+#define CONFIG_ENGINE(config)       ((band_engine_t)(((config) >> 15) & 0x1))
+#define CONFIG_RATE(config)         ((config) >> 16)
+
+#define BOOT_CONFIG ANALYSIS_CONFIG(FFT_SIZE, SAMPLE_RATE_HZ, FFT_MULTIRATE_LEVELS, BAND_ENGINE_DEFAULT)
+
+static volatile uint32_t _requested_config = BOOT_CONFIG;
+static volatile uint32_t _active_config = BOOT_CONFIG;
+
+// Core 0 only: false after every configuration attempt failed
+static bool _analysis_ok = true;
+
+static const uint32_t _sample_rates[] = SAMPLE_RATES_HZ;
+#define NUM_SAMPLE_RATES (sizeof(_sample_rates) / sizeof(_sample_rates[0]))
+
+_Static_assert(FFT_SIZE_MAX <= 0x0FFF && FFT_MULTIRATE_LEVELS_MAX <= 0x7,
+               "FFT size and levels must fit the packed analysis config");
+
+static const char *_engine_names[] = {"FFT", "filter bank"};
+static const char *_stream_names[] = {"off", "bands (uint8)", "bands (uint16)",
+                                      "bands (uint16) + magnitude bins"};
+
+// Magnitude bins for the stream, core 0 only
+static uint16_t _stream_bins[FFT_SIZE_MAX / 2];
+
+// ============================================================================
+// Console
+// ============================================================================
+
+/**
+ * @brief printf for run-time status messages, dropped while streaming
+ * 
+ * The binary stream shares the USB CDC port with stdio; text in the
+ * middle of it costs the host decoder packets (see stats_task()).
+ */
+static void status_printf(const char *format, ...) {
+    if (spectrum_stream_get_mode() != STREAM_OFF) return;
     
-    printf("\n\n");
-    printf("============================================\n");
-    printf("  Real-Time Spectrum Analyzer\n");
-    printf("============================================\n\n");
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+// ============================================================================
+// Analysis Settings (requested from core 1)
+// ============================================================================
+
+/**
+ * @brief Post new analysis settings for core 0 to apply
+ */
+static void request_config(uint32_t config) {
+    // A restart would leave a gap in the recording, and replay runs at the
+    // rate it was recorded at
+    sample_source_mode_t source = sample_source_get_mode();
+    uint32_t capture_rate;
+    if (source == SOURCE_RECORD) {
+        status_printf("Analysis settings are fixed while recording\n");
+        return;
+    }
+    if (source >= SOURCE_REPLAY && sample_source_get_capture(&capture_rate, NULL) &&
+        CONFIG_RATE(config) != capture_rate) {
+        status_printf("Sample rate is fixed at %lu Hz while replaying\n", capture_rate);
+        return;
+    }
     
-    printf("Configuration:\n");
-    printf("  Microphone: MAX4466 on GP%d (ADC%d)\n", AUDIO_PIN_MIC, AUDIO_ADC_MIC);
-    printf("  Sample Rate: %d Hz\n", SAMPLE_RATE_HZ);
-    printf("  FFT Size: %d\n", FFT_SIZE);
-    printf("  Bands: %d\n", NUM_BANDS);
-    printf("  Target FPS: %d\n", TARGET_FPS);
-    printf("  Display: %dx%d\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    status_printf("Analysis: %s, FFT %lu @ %lu Hz, %lu level(s) requested\n",
+                  _engine_names[CONFIG_ENGINE(config)], CONFIG_SIZE(config),
+                  CONFIG_RATE(config), CONFIG_LEVELS(config));
+    _requested_config = config;
+}
+
+/**
+ * @brief Step through FFT sizes (FFT_SIZE_MIN ... FFT_SIZE_MAX, wrapping)
+ */
+static void next_fft_size(void) {
+    uint32_t config = _requested_config;
+    uint32_t size = CONFIG_SIZE(config) * 2;
+    if (size > FFT_SIZE_MAX) size = FFT_SIZE_MIN;
+    request_config(ANALYSIS_CONFIG(size, CONFIG_RATE(config), CONFIG_LEVELS(config),
+                                   CONFIG_ENGINE(config)));
+}
+
+/**
+ * @brief Step through the SAMPLE_RATES_HZ list (wrapping)
+ */
+static void next_sample_rate(void) {
+    uint32_t config = _requested_config;
+    uint32_t rate = CONFIG_RATE(config);
+    
+    // A rate not in the list (boot default) continues from the first one
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < NUM_SAMPLE_RATES; i++) {
+        if (_sample_rates[i] == rate) {
+            index = (i + 1) % NUM_SAMPLE_RATES;
+            break;
+        }
+    }
+    request_config(ANALYSIS_CONFIG(CONFIG_SIZE(config), _sample_rates[index],
+                                   CONFIG_LEVELS(config), CONFIG_ENGINE(config)));
+}
+
+/**
+ * @brief Toggle multirate analysis (FFT_MULTIRATE_LEVELS_MAX <-> 1 level)
+ */
+static void toggle_multirate(void) {
+    uint32_t config = _requested_config;
+    uint32_t levels = (CONFIG_LEVELS(config) > 1) ? 1 : FFT_MULTIRATE_LEVELS_MAX;
+    request_config(ANALYSIS_CONFIG(CONFIG_SIZE(config), CONFIG_RATE(config), levels,
+                                   CONFIG_ENGINE(config)));
+}
+
+/**
+ * @brief Switch between the FFT and the filter bank band engine
+ */
+static void toggle_engine(void) {
+    uint32_t config = _requested_config;
+    band_engine_t engine = (CONFIG_ENGINE(config) == BAND_ENGINE_FFT) ? BAND_ENGINE_FILTERS
+                                                                      : BAND_ENGINE_FFT;
+    request_config(ANALYSIS_CONFIG(CONFIG_SIZE(config), CONFIG_RATE(config),
+                                   CONFIG_LEVELS(config), engine));
+}
+
+/**
+ * @brief Start or stop recording the input to flash
+ */
+static void toggle_recording(void) {
+    if (sample_source_get_mode() == SOURCE_RECORD) {
+        sample_source_request(SOURCE_LIVE);
+    } else if (!sample_source_request(SOURCE_RECORD)) {
+        status_printf("Capture: not available (no capture region, or still writing)\n");
+    }
+}
+
+/**
+ * @brief Start or stop replay of the flash capture in place of the ADC
+ */
+static void toggle_replay(sample_source_mode_t mode) {
+    if (sample_source_get_mode() == mode) {
+        status_printf("Replay: stopped, live input\n");
+        sample_source_request(SOURCE_LIVE);
+        return;
+    }
+    
+    uint32_t rate;
+    if (!sample_source_get_capture(&rate, NULL)) {
+        status_printf("Replay: no capture in flash (record one with 'c')\n");
+        return;
+    }
+    
+    // Rate first: core 0 applies settings before the source, so the replay
+    // starts at the capture's rate
+    uint32_t config = _requested_config;
+    if (CONFIG_RATE(config) != rate) {
+        request_config(ANALYSIS_CONFIG(CONFIG_SIZE(config), rate, CONFIG_LEVELS(config),
+                                       CONFIG_ENGINE(config)));
+    }
+    if (!sample_source_request(mode)) {
+        status_printf("Replay: not available while a recording is written to flash\n");
+    }
+}
+
+/**
+ * @brief Select the binary stream mode (announced before packets start)
+ */
+static void set_stream_mode(stream_mode_t mode) {
+    printf("Stream: %s\n", _stream_names[mode]);
+    spectrum_stream_set_mode(mode);
+}
+
+/**
+ * @brief Handle one serial command character (non-blocking)
+ */
+static void poll_serial_command(void) {
+    int c = getchar_timeout_us(0);
+    if (c == PICO_ERROR_TIMEOUT) return;
+    
+    if (c == 'f') {
+        next_fft_size();
+    } else if (c == 's') {
+        next_sample_rate();
+    } else if (c == 'm') {
+        toggle_multirate();
+    } else if (c == 'e') {
+        toggle_engine();
+    } else if (c == 't') {
+        // Display core tasks since the last stats line
+        scheduler_print_stats(&_display_sched);
+    } else if (c == 'b') {
+        set_stream_mode(STREAM_BANDS8);
+    } else if (c == 'w') {
+        set_stream_mode(STREAM_BANDS16);
+    } else if (c == 'n') {
+        set_stream_mode(STREAM_BANDS_BINS);
+    } else if (c == 'x') {
+        set_stream_mode(STREAM_OFF);
+    } else if (c == 'c') {
+        toggle_recording();
+    } else if (c == 'y') {
+        toggle_replay(SOURCE_REPLAY);
+    } else if (c == 'Y') {
+        toggle_replay(SOURCE_REPLAY_FAST);
+    } else {
+        profiler_handle_command(c);
+    }
+}
+
+// ============================================================================
+// Core 1: Display and UI
+// ============================================================================
+
+// Task state, only touched by core 1
+static uint32_t _last_sequence = 0;
+static uint32_t _ffts_since_stats = 0;
+static uint32_t _frames_dropped = 0;        // Render periods dropped since boot
+
+/**
+ * @brief UI task: serial commands and touch gestures (never blocks)
+ */
+static bool ui_task(void) {
+    // Serial commands ('f' FFT size, 's' sample rate, 'm' multirate,
+    // 'e' band engine, 't' tasks, 'b'/'w'/'n'/'x' stream, 'c' record,
+    // 'y'/'Y' replay, 'p' profile)
+    poll_serial_command();
+    
+    // Gestures arrive through the touch driver's event queue
+    PROFILE_BEGIN(touch);
+    touch_gesture_t gesture = xpt2046_detect_gesture();
+    PROFILE_END(touch, PROF_TOUCH);
+    switch (gesture) {
+        case GESTURE_SWIPE_RIGHT:
+            status_printf("Gesture: Swipe RIGHT -> Next theme\n");
+            theme_manager_next();
+            status_printf("Theme: %s\n", theme_manager_get_name());
+            break;
+        case GESTURE_SWIPE_LEFT:
+            status_printf("Gesture: Swipe LEFT -> Previous theme\n");
+            theme_manager_prev();
+            status_printf("Theme: %s\n", theme_manager_get_name());
+            break;
+        case GESTURE_TAP:
+            status_printf("Gesture: TAP -> Show theme name\n");
+            theme_manager_show_name(2000);  // Show for 2 seconds
+            break;
+        case GESTURE_LONG_PRESS:
+            status_printf("Gesture: LONG PRESS -> Next FFT size\n");
+            next_fft_size();
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+/**
+ * @brief Stream task: hand staged packets to USB as far as it has room
+ */
+static bool stream_task(void) {
+    return spectrum_stream_service();
+}
+
+/**
+ * @brief Network task: Wi-Fi driver, connection and telemetry sends
+ */
+static bool net_task(void) {
+    return udp_telemetry_service();
+}
+
+/**
+ * @brief Render task: draw the newest bands from the audio core (if any)
+ * @return false if nothing new arrived (no frame drawn)
+ */
+static bool render_task(void) {
+    PROFILE_BEGIN(frame);
+    
+    // Update theme overlay (fade out if expired)
+    theme_manager_update_overlay();
+    
+    const band_frame_t *frame = band_buffer_acquire();
+    if (frame) {
+        uint32_t new_frames = frame->sequence - _last_sequence;
+        _ffts_since_stats += new_frames;
+        _last_sequence = frame->sequence;
+        if (new_frames > 1) {
+            profiler_add_counter(PROF_COUNT_FRAMES_SKIPPED, new_frames - 1);
+        }
+        
+        theme_manager_render(frame->levels, frame->peaks, frame->num_bands);
+        udp_telemetry_offer(frame->bands, frame->num_bands);
+    }
+    
+    PROFILE_END(frame, PROF_FRAME);
+    return frame != NULL;
+}
+
+/**
+ * @brief Stats task: periodic performance report
+ * 
+ * Quiet while streaming, so the binary stream is not interleaved with text.
+ */
+static bool stats_task(void) {
+    const sched_task_t *render = _render_task;
+    float interval_s = (time_us_64() - _display_sched.stats_start_us) / 1000000.0f;
+    if (interval_s <= 0.0f) return false;
+    
+    _frames_dropped += render->dropped;
+    profiler_set_counter(PROF_COUNT_FRAMES_DROPPED, _frames_dropped);
+    if (spectrum_stream_get_mode() != STREAM_OFF) {
+        _ffts_since_stats = 0;
+        scheduler_reset_stats(&_display_sched);
+        return true;
+    }
+    
+    float actual_fps = render->runs / interval_s;
+    float fft_rate = _ffts_since_stats / interval_s;
+    float avg_frame_time_ms = render->runs ? render->busy_us / (1000.0f * render->runs) : 0.0f;
+    uint32_t samples_available = adc_sampler_available();
+    
+    printf("FPS: %.1f | FFT/s: %.0f | Frame time: %.2f ms (max: %.2f) | Buffer: %lu samples",
+           actual_fps,
+           fft_rate,
+           avg_frame_time_ms,
+           render->max_us / 1000.0f,
+           samples_available);
+    
+    if (render->dropped > 0) {
+        printf(" | Dropped frames: %lu", render->dropped);
+    }
+    
+    if (_fft_failures > 0) {
+        printf(" | FFT failures: %lu", _fft_failures);
+    }
+    
+    uint32_t overruns = adc_sampler_get_overruns();
+    if (overruns > 0) {
+        printf(" | Dropped samples: %lu", overruns);
+    }
+
+#if AUTO_GAIN_ENABLED
+    printf(" | AGC: x%.1f", band_dynamics_gain() / 256.0f);
+#endif
+    
+    uint32_t udp_dropped = udp_telemetry_dropped();
+    if (udp_dropped > 0) {
+        printf(" | UDP dropped: %lu", udp_dropped);
+    }
     printf("\n");
     
+    // Reset stats
+    _ffts_since_stats = 0;
+    scheduler_reset_stats(&_display_sched);
+    return true;
+}
+
+/**
+ * @brief Display core entry point (owns ILI9341, touch and theme_manager)
+ */
+static void core1_display_main(void) {
+    profiler_start_core();
+    
+    // Core 0 parks this core in RAM while it writes the sample capture
+    multicore_lockout_victim_init();
+    
     // Initialize display
     printf("Initializing display...\n");
     if (!ili9341_init()) {
         printf("ERROR: Display initialization failed!\n");
-        return 1;
+        return;
     }
     
     ili9341_set_rotation(DISPLAY_ROTATION);
@@ -70,12 +462,304 @@ int main(void) {
     theme_manager_init();
     printf("Current theme: %s\n", theme_manager_get_name());
     
+    // Wi-Fi telemetry (SPECTRUM_WIFI_TELEMETRY builds); after display and
+    // touch so the CYW43 driver's DMA channels don't collide with theirs
+    bool telemetry = false;
+#if WIFI_TELEMETRY_ENABLE
+    printf("Initializing Wi-Fi telemetry...\n");
+    telemetry = udp_telemetry_init();
+    if (!telemetry) {
+        printf("WARNING: Wi-Fi telemetry disabled\n");
+    }
+#endif
+    
+    // Priority order: input stays responsive however long a theme takes,
+    // and a late render drops frames instead of bunching them up
+    scheduler_init(&_display_sched);
+    scheduler_add_periodic(&_display_sched, "ui", ui_task, UI_PERIOD_US, false);
+    scheduler_add_periodic(&_display_sched, "stream", stream_task, STREAM_PERIOD_US, false);
+    if (telemetry) {
+        scheduler_add_periodic(&_display_sched, "net", net_task, NET_PERIOD_US, false);
+    }
+    _render_task = scheduler_add_periodic(&_display_sched, "render", render_task,
+                                          FRAME_TIME_US, true);
+    scheduler_add_periodic(&_display_sched, "stats", stats_task, STATS_PERIOD_US, false);
+    
+    scheduler_run(&_display_sched);
+}
+
+// ============================================================================
+// Core 0: Audio Processing
+// ============================================================================
+
+/**
+ * @brief Print the frequency span of every band for the active settings
+ */
+static void print_band_ranges(band_engine_t engine) {
+    status_printf("Frequency bands (%s):\n", _engine_names[engine]);
+    for (uint8_t i = 0; i < NUM_BANDS; i++) {
+        float freq_min, freq_max;
+        if (engine == BAND_ENGINE_FILTERS) {
+            filter_bank_get_band_range(i, &freq_min, &freq_max);
+        } else {
+            fft_processor_get_band_range(i, NUM_BANDS, &freq_min, &freq_max);
+        }
+        status_printf("  Band %2d: %6.1f - %6.1f Hz\n", i, freq_min, freq_max);
+    }
+    status_printf("\n");
+}
+
+/**
+ * @brief Switch sample rate, FFT size, framing, multirate and filter bank together
+ * 
+ * Capture restarts, so the ring realigns to the new hop and no samples
+ * taken at the old rate reach the new frames.
+ */
+static bool configure_analysis(uint32_t config) {
+    uint32_t size = CONFIG_SIZE(config);
+    uint32_t rate = CONFIG_RATE(config);
+    uint8_t levels = (uint8_t)CONFIG_LEVELS(config);
+    
+    return adc_sampler_set_rate(rate) &&
+           fft_processor_configure(size, rate) &&
+           fft_processor_set_levels(levels) &&
+           stft_framer_configure(size) &&
+           band_dynamics_configure(stft_framer_hop_size(), rate) &&
+           multirate_configure(size, levels) &&
+           filter_bank_configure(rate, NUM_BANDS);
+}
+
+/**
+ * @brief Last resort after a failed (re)configuration: the boot settings
+ * 
+ * Leaves both the active and the requested settings at what is running.
+ * @return true if the boot settings could be applied
+ */
+static bool fall_back_to_boot_config(void) {
+    bool ok = configure_analysis(BOOT_CONFIG);
+    if (ok) {
+        status_printf("Analysis: falling back to FFT %d @ %d Hz\n", FFT_SIZE, SAMPLE_RATE_HZ);
+    } else {
+        status_printf("ERROR: Analysis setup failed, no band data until the next change\n");
+    }
+    
+    _active_config = BOOT_CONFIG;
+    _requested_config = BOOT_CONFIG;
+    _analysis_ok = ok;
+    return ok;
+}
+
+/**
+ * @brief Start framing, band engines and band dynamics from clean state
+ * 
+ * On failure the boot settings are tried instead (see _analysis_ok).
+ */
+static void restart_analysis(void) {
+    band_dynamics_init();
+    if (configure_analysis(_active_config)) {
+        _analysis_ok = true;
+        return;
+    }
+    
+    status_printf("ERROR: Restarting FFT %lu @ %lu Hz failed\n",
+                  CONFIG_SIZE(_active_config), CONFIG_RATE(_active_config));
+    fall_back_to_boot_config();
+}
+
+/**
+ * @brief Apply settings requested by core 1 (between hops, no block held)
+ */
+static void apply_requested_config(void) {
+    uint32_t requested = _requested_config;
+    uint32_t active = _active_config;
+    if (requested == active) return;
+    
+    uint32_t size = CONFIG_SIZE(requested);
+    uint32_t rate = CONFIG_RATE(requested);
+    if (!configure_analysis(requested)) {
+        status_printf("ERROR: FFT %lu @ %lu Hz not supported, keeping FFT %lu @ %lu Hz\n",
+                      size, rate, CONFIG_SIZE(active), CONFIG_RATE(active));
+        if (configure_analysis(active)) {
+            _requested_config = active;
+            _analysis_ok = true;
+        } else {
+            status_printf("ERROR: Restoring FFT %lu @ %lu Hz failed\n",
+                          CONFIG_SIZE(active), CONFIG_RATE(active));
+            fall_back_to_boot_config();
+        }
+        return;
+    }
+    
+    _active_config = requested;
+    _analysis_ok = true;
+    status_printf("Analysis: %s, FFT %lu @ %lu Hz (hop %lu, %.0f FFTs/s, %.1f Hz/bin), %lu level(s)\n",
+                  _engine_names[CONFIG_ENGINE(requested)], size, rate, stft_framer_hop_size(),
+                  (float)rate / stft_framer_hop_size(), (float)rate / size, CONFIG_LEVELS(requested));
+    print_band_ranges(CONFIG_ENGINE(requested));
+}
+
+/**
+ * @brief FFT band engine: lower-rate levels that completed, then full rate
+ * 
+ * The full-rate FFT runs last and writes the merged result.
+ */
+static bool compute_fft_bands(const fft_sample_t *frame_samples, uint8_t levels_ready, float *bands) {
+    bool ok = true;
+    for (uint8_t level = 1; level < multirate_levels(); level++) {
+        if (levels_ready & (1u << level)) {
+            ok &= fft_processor_compute_level(level, multirate_frame(level), bands, NUM_BANDS);
+        }
+    }
+    
+    return ok && fft_processor_compute_frame(frame_samples, bands, NUM_BANDS);
+}
+
+/**
+ * @brief Queue a published band frame (and the FFT bins) for the USB stream
+ */
+static void stream_frame(band_engine_t engine, const float *bands) {
+    stream_mode_t mode = spectrum_stream_get_mode();
+    if (mode == STREAM_OFF) return;
+    
+    uint32_t now = time_us_32();
+    spectrum_stream_push_bands(bands, NUM_BANDS, now);
+    if (mode == STREAM_BANDS_BINS && engine == BAND_ENGINE_FFT) {
+        uint32_t num_bins = fft_processor_get_magnitudes(_stream_bins, FFT_SIZE_MAX / 2);
+        spectrum_stream_push_bins(_stream_bins, (uint16_t)num_bins,
+                                  CONFIG_RATE(_active_config), now);
+    }
+}
+
+/**
+ * @brief Run the band engine on every available hop and publish each result
+ * @return Number of hops processed
+ */
+static uint32_t process_audio(void) {
+    uint32_t hops = 0;
+    
+    apply_requested_config();
+    
+    // Replay starting or ending: every replay sees the same input from the
+    // same state
+    if (sample_source_update()) {
+        restart_analysis();
+    }
+    
+    // Nothing to run the hops through until a setting change succeeds
+    if (!_analysis_ok) return 0;
+    band_engine_t engine = CONFIG_ENGINE(_active_config);
+    
+    // Live hops are read straight out of the DMA ring (no copy); stop
+    // early for new settings (max-speed replay always has hops ready)
+    uint32_t hop_size = stft_framer_hop_size();
+    const uint16_t *audio_samples;
+    while (_requested_config == _active_config &&
+           (audio_samples = sample_source_acquire_block(hop_size)) != NULL) {
+        PROFILE_BEGIN(adc);
+        bool frame_ready = stft_framer_push(audio_samples);
+        sample_source_release_block();
+        
+        // Newest hop, already normalized, feeds the incremental stages
+        const fft_sample_t *frame_samples = stft_framer_frame();
+        const fft_sample_t *newest = &frame_samples[stft_framer_frame_size() - hop_size];
+        uint8_t levels_ready = 0;
+        if (engine == BAND_ENGINE_FFT) {
+            levels_ready = multirate_push(newest, hop_size);
+        }
+        PROFILE_END(adc, PROF_ADC);
+        hops++;
+        
+        // Extract frequency bands into the next free slot
+        band_frame_t *frame;
+        bool ok;
+        if (engine == BAND_ENGINE_FILTERS) {
+            // Filters need no full frame; publish at the hop rate
+            filter_bank_push(newest, hop_size);
+            frame = band_buffer_begin_write();
+            ok = filter_bank_get_bands(frame->bands, NUM_BANDS);
+        } else {
+            if (!frame_ready) continue;
+            frame = band_buffer_begin_write();
+            ok = compute_fft_bands(frame_samples, levels_ready, frame->bands);
+        }
+        
+        if (ok) {
+            PROFILE_BEGIN(dynamics);
+            band_dynamics_process(frame->bands, NUM_BANDS, frame->levels, frame->peaks);
+            PROFILE_END(dynamics, PROF_DYNAMICS);
+            frame->num_bands = NUM_BANDS;
+            stream_frame(engine, frame->bands);
+            band_buffer_publish();
+        } else {
+            _fft_failures++;
+            profiler_add_counter(PROF_COUNT_FFT_FAILURES, 1);
+        }
+    }
+    
+    profiler_set_counter(PROF_COUNT_ADC_OVERRUNS, adc_sampler_get_overruns());
+    return hops;
+}
+
+/**
+ * @brief Audio task readiness: a full hop from the source or new settings
+ */
+static bool audio_ready(void) {
+    return _requested_config != _active_config ||
+           sample_source_available() >= stft_framer_hop_size();
+}
+
+/**
+ * @brief Audio task: process every hop that is ready
+ */
+static bool audio_task(void) {
+    return process_audio() > 0;
+}
+
+/**
+ * @brief Capture task: one flash erase or page program of a recording
+ */
+static bool capture_task(void) {
+    return sample_source_service();
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(void) {
+    // Initialize stdio - wait for USB
+    stdio_init_all();
+    sleep_ms(2000);
+    
+    printf("\n\n");
+    printf("============================================\n");
+    printf("  Real-Time Spectrum Analyzer\n");
+    printf("============================================\n\n");
+    
+    printf("Configuration:\n");
+    printf("  Microphone: MAX4466 on GP%d (ADC%d)\n", AUDIO_PIN_MIC, AUDIO_ADC_MIC);
+    printf("  Sample Rate: %d Hz\n", SAMPLE_RATE_HZ);
+    printf("  FFT Size: %d (hop %lu, %.0f FFTs/s)\n", FFT_SIZE, FFT_HOP_SIZE, FFT_RATE_HZ);
+    printf("  Multirate: %d level(s)\n", FFT_MULTIRATE_LEVELS);
+    printf("  Band engine: %s\n", _engine_names[BAND_ENGINE_DEFAULT]);
+    printf("  Bands: %d\n", NUM_BANDS);
+    printf("  Target FPS: %d\n", TARGET_FPS);
+    printf("  Display: %dx%d\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    printf("  Cores: audio=%d, display=%d\n", CORE_AUDIO, CORE_DISPLAY);
+    printf("\n");
+    
+    // Cycle counters for both cores (core 1 starts its own)
+    profiler_init();
+    
     // Initialize ADC sampler
     printf("Initializing ADC sampler...\n");
     if (!adc_sampler_init(AUDIO_ADC_MIC, SAMPLE_RATE_HZ)) {
         printf("ERROR: ADC sampler initialization failed!\n");
         return 1;
     }
+    if (!sample_source_init(AUDIO_ADC_MIC)) {
+        printf("WARNING: No room for the capture region, recording and replay disabled\n");
+    }
     
     // Initialize FFT processor
     printf("Initializing FFT processor...\n");
@@ -83,6 +767,25 @@ int main(void) {
         printf("ERROR: FFT processor initialization failed!\n");
         return 1;
     }
+    stft_framer_init();
+    band_dynamics_init();
+    if (!fft_processor_set_levels(FFT_MULTIRATE_LEVELS) ||
+        !multirate_configure(FFT_SIZE, FFT_MULTIRATE_LEVELS)) {
+        printf("ERROR: Multirate analysis setup failed!\n");
+        return 1;
+    }
+    if (!filter_bank_configure(SAMPLE_RATE_HZ, NUM_BANDS)) {
+        printf("ERROR: Filter bank setup failed!\n");
+        return 1;
+    }
+    
+    // Print frequency band ranges
+    print_band_ranges(BAND_ENGINE_DEFAULT);
+    
+    // Hand the display stage to the other core
+    band_buffer_init();
+    spectrum_stream_init();
+    multicore_launch_core1(core1_display_main);
     
     // Start sampling
     printf("Starting audio capture...\n");
@@ -97,139 +800,30 @@ int main(void) {
     
     printf("Touch controls:\n");
     printf("  • Swipe LEFT/RIGHT: Change visualization theme\n");
-    printf("  • TAP: Show current theme name\n\n");
+    printf("  • TAP: Show current theme name\n");
+    printf("  • LONG PRESS: Next FFT size (%d ... %d)\n\n", FFT_SIZE_MIN, FFT_SIZE_MAX);
     
-    printf("Performance stats will be printed periodically...\n\n");
-    
-    // Print frequency band ranges
-    printf("Frequency bands:\n");
-    for (uint8_t i = 0; i < NUM_BANDS; i++) {
-        float freq_min, freq_max;
-        fft_processor_get_band_range(i, NUM_BANDS, &freq_min, &freq_max);
-        printf("  Band %2d: %6.1f - %6.1f Hz\n", i, freq_min, freq_max);
-    }
+    printf("Serial commands: 'f' = next FFT size, 's' = next sample rate, 'm' = multirate on/off\n");
+    printf("                 'e' = FFT / filter bank band engine, 't' = display task stats\n");
+    printf("                 'b'/'w'/'n' = binary stream bands8/bands16/bands+bins, 'x' = stop\n");
+    printf("                 'c' = record to flash on/off, 'y'/'Y' = replay real time/max speed\n");
+#if PROFILE_ENABLE
+    printf("                 'p' = profile dump, 'r' = profile reset\n");
+#endif
     printf("\n");
     
-    // Allocate buffers
-    uint16_t audio_samples[FFT_SIZE];
-    float frequency_bands[NUM_BANDS];
-    
-    // Timing variables
-    absolute_time_t next_frame_time = get_absolute_time();
-    absolute_time_t last_stats_time = get_absolute_time();
-    uint32_t frame_count = 0;
-    uint32_t frames_since_stats = 0;
-    
-    uint32_t min_frame_time_us = UINT32_MAX;
-    uint32_t max_frame_time_us = 0;
-    uint32_t total_frame_time_us = 0;
-    uint32_t fft_failures = 0;
+    printf("Performance stats will be printed periodically...\n\n");
     
-    // Main loop
-    while (true) {
-        absolute_time_t frame_start = get_absolute_time();
-        
-        // Handle touch input and gestures
-        touch_gesture_t gesture = xpt2046_detect_gesture();
-        switch (gesture) {
-            case GESTURE_SWIPE_RIGHT:
-                printf("Gesture: Swipe RIGHT -> Next theme\n");
-                theme_manager_next();
-                printf("Theme: %s\n", theme_manager_get_name());
-                break;
-            case GESTURE_SWIPE_LEFT:
-                printf("Gesture: Swipe LEFT -> Previous theme\n");
-                theme_manager_prev();
-                printf("Theme: %s\n", theme_manager_get_name());
-                break;
-            case GESTURE_TAP:
-                printf("Gesture: TAP -> Show theme name\n");
-                theme_manager_show_name(2000);  // Show for 2 seconds
-                break;
-            case GESTURE_LONG_PRESS:
-                printf("Gesture: LONG PRESS -> (Future: Settings menu)\n");
-                break;
-            default:
-                break;
-        }
-        
-        // Update theme overlay (fade out if expired)
-        theme_manager_update_overlay();
-        
-        // Check if we have enough samples for FFT
-        if (adc_sampler_available() >= FFT_SIZE) {
-            // Read samples
-            uint32_t samples_read = adc_sampler_read(audio_samples, FFT_SIZE);
-            
-            if (samples_read == FFT_SIZE) {
-                // Perform FFT and extract frequency bands
-                if (fft_processor_compute(audio_samples, frequency_bands, NUM_BANDS)) {
-                    // Render current theme visualization
-                    theme_manager_render(frequency_bands, NUM_BANDS);
-                } else {
-                    fft_failures++;
-                }
-            }
-        }
-        
-        // Calculate frame timing
-        absolute_time_t frame_end = get_absolute_time();
-        uint32_t frame_time_us = absolute_time_diff_us(frame_start, frame_end);
-        
-        // Update stats
-        if (frame_time_us < min_frame_time_us) min_frame_time_us = frame_time_us;
-        if (frame_time_us > max_frame_time_us) max_frame_time_us = frame_time_us;
-        total_frame_time_us += frame_time_us;
-        
-        frame_count++;
-        frames_since_stats++;
-        
-        // Print stats every 5 seconds
-        int64_t stats_interval_us = absolute_time_diff_us(last_stats_time, frame_end);
-        if (stats_interval_us >= 5000000) {  // 5 seconds
-            float actual_fps = (float)frames_since_stats / (stats_interval_us / 1000000.0f);
-            float avg_frame_time_ms = (total_frame_time_us / (float)frames_since_stats) / 1000.0f;
-            uint32_t samples_available = adc_sampler_available();
-            
-            printf("Frame %lu | FPS: %.1f | Frame time: %.2f ms (min: %.2f, max: %.2f) | Buffer: %lu samples",
-                   frame_count,
-                   actual_fps,
-                   avg_frame_time_ms,
-                   min_frame_time_us / 1000.0f,
-                   max_frame_time_us / 1000.0f,
-                   samples_available);
-            
-            if (fft_failures > 0) {
-                printf(" | FFT failures: %lu", fft_failures);
-            }
-            printf("\n");
-            
-            // Reset stats
-            last_stats_time = frame_end;
-            frames_since_stats = 0;
-            min_frame_time_us = UINT32_MAX;
-            max_frame_time_us = 0;
-            total_frame_time_us = 0;
-            fft_failures = 0;
-        }
-        
-        // Frame rate limiting
-        next_frame_time = delayed_by_us(next_frame_time, FRAME_TIME_US);
-        
-        // Check if we're falling behind
-        int64_t time_until_next = absolute_time_diff_us(frame_end, next_frame_time);
-        if (time_until_next < 0) {
-            // We're behind schedule, skip waiting and catch up
-            next_frame_time = frame_end;
-        } else {
-            // Wait until next frame
-            sleep_until(next_frame_time);
-        }
-    }
+    // Audio runs on sample-block events only; with nothing ready the core
+    // sleeps until the next DMA block interrupt. Recording writes flash in
+    // the time audio leaves.
+    scheduler_init(&_audio_sched);
+    scheduler_add_event(&_audio_sched, "audio", audio_task, audio_ready);
+    scheduler_add_event(&_audio_sched, "capture", capture_task, sample_source_flash_pending);
+    scheduler_run(&_audio_sched);
     
     // Cleanup (never reached in normal operation)
     adc_sampler_stop();
     
     return 0;
 }
-
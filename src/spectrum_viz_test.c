@@ -9,7 +9,10 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "display/ili9341.h"
+#include "display/strip_renderer.h"
+#include "display/palette.h"
 #include "display/themes/bars.h"
+#include "audio/band_dynamics.h"
 #include "utils/mock_audio.h"
 #include "config.h"
 
@@ -53,9 +56,15 @@ int main(void) {
     
     // Initialize visualization
     printf("Initializing visualization...\n");
+    strip_renderer_init();
+    palette_init();
     bars_init();
     bars_clear();
     
+    // Smoothing and peak hold at the frame rate (one band frame per frame)
+    band_dynamics_init();
+    band_dynamics_configure(1, TARGET_FPS);
+    
     // Initialize mock audio generator
     printf("Initializing mock audio generator...\n");
     mock_audio_init();
@@ -70,8 +79,10 @@ int main(void) {
     
     printf("Performance stats will be printed periodically...\n\n");
     
-    // Allocate buffer for frequency bands
+    // Allocate buffers for frequency bands and their display levels
     float bands[NUM_BANDS];
+    uint16_t levels[NUM_BANDS];
+    uint16_t peaks[NUM_BANDS];
     
     // Timing variables
     absolute_time_t next_frame_time = get_absolute_time();
@@ -89,9 +100,12 @@ int main(void) {
         
         // Generate mock audio data
         mock_audio_generate(bands, NUM_BANDS, PATTERN_AUTO);
+        band_dynamics_process(bands, NUM_BANDS, levels, peaks);
         
         // Render visualization
-        bars_render(bands, NUM_BANDS);
+        strip_renderer_begin_frame(ILI9341_BLACK);
+        bars_render(levels, peaks, NUM_BANDS);
+        strip_renderer_end_frame();
         
         // Calculate frame timing
         absolute_time_t frame_end = get_absolute_time();
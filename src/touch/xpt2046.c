@@ -1,13 +1,32 @@
 /**
  * @file xpt2046.c
  * @brief XPT2046 touch controller implementation
+ * 
+ * Touch is handled entirely in interrupts, on the core that called
+ * xpt2046_init():
+ * 
+ * - The falling edge of TOUCH_PIN_IRQ (pen down) starts sampling
+ * - A repeating timer starts one scan every 1 / TOUCH_SAMPLE_RATE_HZ
+ * - A scan is a fixed command sequence clocked out and read back on
+ *   TOUCH_SPI_PORT by two DMA channels, so no SPI time is spent on the CPU
+ * - The RX completion IRQ filters the scan (median of the X/Y conversions),
+ *   runs the gesture detector and queues detected gestures
+ * - Once the pen has been up for TOUCH_DEBOUNCE_MS sampling stops and the
+ *   pin interrupt is re-armed
+ * 
+ * The display loop only pops the gesture queue, so it never waits on the
+ * touch controller.
  */
 
 #include "touch/xpt2046.h"
 #include "config.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
 #include "pico/stdlib.h"
+#include "pico/util/queue.h"
 
 // ============================================================================
 // XPT2046 Commands
@@ -31,6 +50,27 @@
 // Pressure threshold
 #define PRESSURE_THRESHOLD 400
 
+// ============================================================================
+// Scan Layout
+// ============================================================================
+
+// Each conversion is one command byte followed by two result bytes
+#define CONVERSION_BYTES    3
+#define SCAN_Z1             0
+#define SCAN_Z2             1
+#define SCAN_X              2                               // First X conversion
+#define SCAN_Y              (SCAN_X + TOUCH_MEDIAN_SAMPLES) // First Y conversion
+#define SCAN_CONVERSIONS    (SCAN_Y + TOUCH_MEDIAN_SAMPLES)
+#define SCAN_BYTES          (SCAN_CONVERSIONS * CONVERSION_BYTES)
+
+#define SAMPLE_PERIOD_US    (1000000 / TOUCH_SAMPLE_RATE_HZ)
+#define IDLE_SCANS_TO_STOP  ((TOUCH_DEBOUNCE_MS * TOUCH_SAMPLE_RATE_HZ + 999) / 1000)
+
+_Static_assert(TOUCH_MEDIAN_SAMPLES % 2 == 1 && TOUCH_MEDIAN_SAMPLES <= 15,
+               "TOUCH_MEDIAN_SAMPLES must be odd (and small)");
+_Static_assert(SCAN_BYTES * 8 * 1000000ull / TOUCH_SPI_SPEED < SAMPLE_PERIOD_US,
+               "Touch scan does not fit in the sample period");
+
 // ============================================================================
 // Gesture Detection State
 // ============================================================================
@@ -42,27 +82,280 @@ static struct {
     uint16_t last_x;
     uint16_t last_y;
     absolute_time_t touch_start_time;
-    absolute_time_t touch_end_time;
+    absolute_time_t touch_end_time;     // Time of the last pressed scan
 } _gesture_state = {0};
 
+// ============================================================================
+// Sampling State
+// ============================================================================
+
+static uint8_t _scan_tx[SCAN_BYTES];
+static uint8_t _scan_rx[SCAN_BYTES];
+
+static queue_t _gesture_queue;
+static alarm_pool_t *_alarm_pool = NULL;
+static repeating_timer_t _sample_timer;
+
+static touch_point_t _latest = {0};     // Last filtered scan (IRQ owned)
+static volatile bool _sampling = false; // Timer running, pin IRQ disarmed
+static volatile bool _scan_busy = false;
+static uint32_t _idle_scans = 0;        // Consecutive scans without pressure
+
 // ============================================================================
 // Private Functions
 // ============================================================================
 
 /**
- * @brief Send command and read 12-bit result
+ * @brief 12-bit result of one conversion in the scan
  */
-static uint16_t xpt2046_read_data(uint8_t command) {
-    uint8_t tx_buf[3] = {command, 0x00, 0x00};
-    uint8_t rx_buf[3] = {0};
+static inline uint16_t scan_result(uint32_t conversion) {
+    const uint8_t *rx = &_scan_rx[conversion * CONVERSION_BYTES];
+    return (((rx[1] << 8) | rx[2]) >> 3) & 0x0FFF;
+}
+
+/**
+ * @brief Median of consecutive conversions in the scan
+ */
+static uint16_t scan_median(uint32_t first) {
+    uint16_t v[TOUCH_MEDIAN_SAMPLES];
     
-    gpio_put(TOUCH_PIN_CS, 0);  // Select touch controller
-    spi_write_read_blocking(TOUCH_SPI_PORT, tx_buf, rx_buf, 3);
-    gpio_put(TOUCH_PIN_CS, 1);  // Deselect
+    // Insertion sort, a handful of values
+    for (uint32_t i = 0; i < TOUCH_MEDIAN_SAMPLES; i++) {
+        uint16_t x = scan_result(first + i);
+        uint32_t j = i;
+        while (j > 0 && v[j - 1] > x) {
+            v[j] = v[j - 1];
+            j--;
+        }
+        v[j] = x;
+    }
+    return v[TOUCH_MEDIAN_SAMPLES / 2];
+}
+
+/**
+ * @brief Fill the command bytes of the scan (result bytes stay 0)
+ */
+static void build_scan(void) {
+    static const uint8_t fixed[SCAN_X] = {XPT2046_CMD_Z1, XPT2046_CMD_Z2};
+    
+    for (uint32_t i = 0; i < SCAN_CONVERSIONS; i++) {
+        uint8_t cmd = (i < SCAN_X) ? fixed[i] : (i < SCAN_Y) ? XPT2046_CMD_X : XPT2046_CMD_Y;
+        _scan_tx[i * CONVERSION_BYTES] = cmd;
+    }
+}
+
+/**
+ * @brief Select the controller and clock one scan through both DMA channels
+ */
+static void start_scan(void) {
+    if (_scan_busy) return;  // SPI slower than the timer; skip a tick
+    _scan_busy = true;
+    
+    gpio_put(TOUCH_PIN_CS, 0);
+    dma_channel_set_write_addr(DMA_CHANNEL_TOUCH_RX, _scan_rx, false);
+    dma_channel_set_read_addr(DMA_CHANNEL_TOUCH, _scan_tx, false);
+    
+    // Start together so RX never falls behind TX
+    dma_start_channel_mask((1u << DMA_CHANNEL_TOUCH) | (1u << DMA_CHANNEL_TOUCH_RX));
+}
+
+/**
+ * @brief Advance the gesture detector by one scan
+ * @return Gesture completed by this scan (GESTURE_NONE if none)
+ */
+static touch_gesture_t update_gesture(const touch_point_t *point, absolute_time_t now) {
+    bool currently_touched = point->is_pressed;
+    
+    // Touch started
+    if (currently_touched && !_gesture_state.is_touching) {
+        _gesture_state.is_touching = true;
+        _gesture_state.start_x = point->x;
+        _gesture_state.start_y = point->y;
+        _gesture_state.last_x = point->x;
+        _gesture_state.last_y = point->y;
+        _gesture_state.touch_start_time = now;
+        _gesture_state.touch_end_time = now;
+        return GESTURE_NONE;
+    }
+    
+    // Touch continuing
+    if (currently_touched && _gesture_state.is_touching) {
+        _gesture_state.last_x = point->x;
+        _gesture_state.last_y = point->y;
+        _gesture_state.touch_end_time = now;
+        return GESTURE_NONE;
+    }
+    
+    // Short lift-offs (bounce, light pressure) don't end the touch
+    if (!currently_touched && _gesture_state.is_touching &&
+        absolute_time_diff_us(_gesture_state.touch_end_time, now) >= TOUCH_DEBOUNCE_MS * 1000) {
+        _gesture_state.is_touching = false;
+        
+        // Calculate touch duration
+        int64_t duration_ms = absolute_time_diff_us(_gesture_state.touch_start_time,
+                                                     _gesture_state.touch_end_time) / 1000;
+        
+        // Calculate movement
+        int32_t dx = (int32_t)_gesture_state.last_x - (int32_t)_gesture_state.start_x;
+        int32_t dy = (int32_t)_gesture_state.last_y - (int32_t)_gesture_state.start_y;
+        int32_t distance = dx * dx + dy * dy;  // Squared distance
+        
+        // Long press detection
+        if (duration_ms > TOUCH_HOLD_TIME_MS && distance < (SWIPE_THRESHOLD_PX * SWIPE_THRESHOLD_PX)) {
+            return GESTURE_LONG_PRESS;
+        }
+        
+        // Tap detection
+        if (duration_ms < SWIPE_TIMEOUT_MS && distance < (SWIPE_THRESHOLD_PX * SWIPE_THRESHOLD_PX)) {
+            return GESTURE_TAP;
+        }
+        
+        // Swipe detection
+        if (duration_ms < SWIPE_TIMEOUT_MS && distance >= (SWIPE_THRESHOLD_PX * SWIPE_THRESHOLD_PX)) {
+            // Determine swipe direction
+            if (abs(dx) > abs(dy)) {
+                // Horizontal swipe
+                return (dx > 0) ? GESTURE_SWIPE_RIGHT : GESTURE_SWIPE_LEFT;
+            } else {
+                // Vertical swipe
+                return (dy > 0) ? GESTURE_SWIPE_DOWN : GESTURE_SWIPE_UP;
+            }
+        }
+    }
+    
+    return GESTURE_NONE;
+}
+
+/**
+ * @brief Re-arm the pen-down interrupt (sampling has stopped)
+ */
+static void arm_pen_irq(void) {
+    // Drop the edges the controller produced during the last scans
+    gpio_acknowledge_irq(TOUCH_PIN_IRQ, GPIO_IRQ_EDGE_FALL);
+    gpio_set_irq_enabled(TOUCH_PIN_IRQ, GPIO_IRQ_EDGE_FALL, true);
+}
+
+/**
+ * @brief Stop periodic scans and wait for the next pen-down edge
+ */
+static void stop_sampling(void) {
+    // Timer and scan IRQs run on the same core, so this cannot race a tick
+    cancel_repeating_timer(&_sample_timer);
+    _sampling = false;
+    arm_pen_irq();
+}
+
+/**
+ * @brief Scan completion: filter, detect gestures, stop when released
+ */
+static void __not_in_flash_func(touch_dma_irq_handler)(void) {
+    if (!(dma_hw->ints1 & (1u << DMA_CHANNEL_TOUCH_RX))) return;
+    dma_hw->ints1 = 1u << DMA_CHANNEL_TOUCH_RX;
     
-    // Combine 12-bit result from bytes 1 and 2
-    uint16_t result = ((rx_buf[1] << 8) | rx_buf[2]) >> 3;
-    return result & 0x0FFF;
+    gpio_put(TOUCH_PIN_CS, 1);
+    _scan_busy = false;
+    
+    // Position from the medians, pressure from the X median
+    uint16_t x = scan_median(SCAN_X);
+    uint16_t y = scan_median(SCAN_Y);
+    uint16_t z1 = scan_result(SCAN_Z1);
+    uint16_t z2 = scan_result(SCAN_Z2);
+    
+    uint16_t pressure = 0;
+    if (z1 != 0 && z2 > z1) {
+        pressure = (x * (z2 - z1)) / z1;
+    }
+    
+    touch_point_t point = {
+        .x = x,
+        .y = y,
+        .pressure = pressure,
+        .is_pressed = pressure >= PRESSURE_THRESHOLD,
+    };
+    if (point.is_pressed) {
+        _latest = point;
+    } else {
+        _latest.is_pressed = false;
+    }
+    
+    touch_gesture_t gesture = update_gesture(&point, get_absolute_time());
+    if (gesture != GESTURE_NONE) {
+        // Queue full: the display loop is far behind, drop the gesture
+        queue_try_add(&_gesture_queue, &gesture);
+    }
+    
+    // Keep sampling through the debounce, also after a pen-down edge whose
+    // first scans saw no pressure yet
+    _idle_scans = point.is_pressed ? 0 : _idle_scans + 1;
+    if (!_gesture_state.is_touching && _idle_scans >= IDLE_SCANS_TO_STOP) {
+        stop_sampling();
+    }
+}
+
+/**
+ * @brief Sample clock while the panel is touched
+ */
+static bool sample_timer_callback(repeating_timer_t *timer) {
+    (void)timer;
+    start_scan();
+    return true;  // Cancelled by stop_sampling()
+}
+
+/**
+ * @brief Start periodic scans (first one immediately)
+ */
+static void start_sampling(void) {
+    if (_sampling) return;
+    _sampling = true;
+    _idle_scans = 0;
+    
+    // The pin toggles during conversions; ignore it until sampling stops
+    gpio_set_irq_enabled(TOUCH_PIN_IRQ, GPIO_IRQ_EDGE_FALL, false);
+    
+    start_scan();
+    
+    // Negative delay: period measured between callback starts (fixed rate)
+    alarm_pool_add_repeating_timer_us(_alarm_pool, -(int64_t)SAMPLE_PERIOD_US,
+                                      sample_timer_callback, NULL, &_sample_timer);
+}
+
+/**
+ * @brief Pen-down interrupt
+ */
+static void __not_in_flash_func(touch_gpio_irq_handler)(void) {
+    if (!(gpio_get_irq_event_mask(TOUCH_PIN_IRQ) & GPIO_IRQ_EDGE_FALL)) return;
+    gpio_acknowledge_irq(TOUCH_PIN_IRQ, GPIO_IRQ_EDGE_FALL);
+    
+    start_sampling();
+}
+
+/**
+ * @brief Configure the TX (commands) and RX (results) DMA channels
+ */
+static void setup_dma(void) {
+    spi_hw_t *hw = spi_get_hw(TOUCH_SPI_PORT);
+    
+    dma_channel_claim(DMA_CHANNEL_TOUCH);
+    dma_channel_config tx = dma_channel_get_default_config(DMA_CHANNEL_TOUCH);
+    channel_config_set_transfer_data_size(&tx, DMA_SIZE_8);
+    channel_config_set_read_increment(&tx, true);
+    channel_config_set_write_increment(&tx, false);
+    channel_config_set_dreq(&tx, spi_get_dreq(TOUCH_SPI_PORT, true));
+    dma_channel_configure(DMA_CHANNEL_TOUCH, &tx, &hw->dr, _scan_tx, SCAN_BYTES, false);
+    
+    dma_channel_claim(DMA_CHANNEL_TOUCH_RX);
+    dma_channel_config rx = dma_channel_get_default_config(DMA_CHANNEL_TOUCH_RX);
+    channel_config_set_transfer_data_size(&rx, DMA_SIZE_8);
+    channel_config_set_read_increment(&rx, false);
+    channel_config_set_write_increment(&rx, true);
+    channel_config_set_dreq(&rx, spi_get_dreq(TOUCH_SPI_PORT, false));
+    dma_channel_configure(DMA_CHANNEL_TOUCH_RX, &rx, _scan_rx, &hw->dr, SCAN_BYTES, false);
+    
+    // The last RX byte marks the end of the scan (TX finishes earlier)
+    dma_channel_set_irq1_enabled(DMA_CHANNEL_TOUCH_RX, true);
+    irq_add_shared_handler(DMA_IRQ_1, touch_dma_irq_handler,
+                           PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
 }
 
 // ============================================================================
@@ -84,7 +377,7 @@ bool xpt2046_init(void) {
     gpio_set_dir(TOUCH_PIN_CS, GPIO_OUT);
     gpio_put(TOUCH_PIN_CS, 1);  // Deselect
     
-    // IRQ pin (optional, active low when touched)
+    // IRQ pin (active low when touched)
     gpio_init(TOUCH_PIN_IRQ);
     gpio_set_dir(TOUCH_PIN_IRQ, GPIO_IN);
     gpio_pull_up(TOUCH_PIN_IRQ);
@@ -92,52 +385,42 @@ bool xpt2046_init(void) {
     // Initialize gesture state
     _gesture_state.is_touching = false;
     
-    DEBUG_PRINTF("XPT2046 touch controller initialized\n");
+    // Interrupts and timer callbacks all run on this core
+    queue_init(&_gesture_queue, sizeof(touch_gesture_t), TOUCH_EVENT_QUEUE_DEPTH);
+    _alarm_pool = alarm_pool_create_with_unused_hardware_alarm(1);
+    build_scan();
+    setup_dma();
+    
+    gpio_add_raw_irq_handler(TOUCH_PIN_IRQ, touch_gpio_irq_handler);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+    arm_pen_irq();
+    
+    // Already touched at boot: the edge has been missed
+    if (!gpio_get(TOUCH_PIN_IRQ)) {
+        start_sampling();
+    }
+    
+    DEBUG_PRINTF("XPT2046 touch controller initialized (IRQ + DMA, %d Hz, median of %d)\n",
+                 TOUCH_SAMPLE_RATE_HZ, TOUCH_MEDIAN_SAMPLES);
     return true;
 }
 
 bool xpt2046_is_touched(void) {
-    // Check IRQ pin (active low when touched)
-    return !gpio_get(TOUCH_PIN_IRQ);
+    return _latest.is_pressed;
 }
 
 bool xpt2046_read(touch_point_t *point) {
     if (!point) return false;
     
-    // Check if touched
-    if (!xpt2046_is_touched()) {
-        point->is_pressed = false;
-        return false;
-    }
-    
-    // Read X, Y, and pressure
-    uint16_t x = xpt2046_read_data(XPT2046_CMD_X);
-    uint16_t y = xpt2046_read_data(XPT2046_CMD_Y);
-    uint16_t z1 = xpt2046_read_data(XPT2046_CMD_Z1);
-    uint16_t z2 = xpt2046_read_data(XPT2046_CMD_Z2);
-    
-    // Calculate pressure
-    uint16_t pressure = 0;
-    if (z1 != 0) {
-        pressure = (x * (z2 - z1)) / z1;
-    }
-    
-    // Check if pressure is sufficient
-    if (pressure < PRESSURE_THRESHOLD) {
-        point->is_pressed = false;
-        return false;
-    }
-    
-    // Fill in touch point
-    point->x = x;
-    point->y = y;
-    point->pressure = pressure;
-    point->is_pressed = true;
+    // The scan IRQ may update the point mid-copy
+    uint32_t irq = save_and_disable_interrupts();
+    *point = _latest;
+    restore_interrupts(irq);
     
-    return true;
+    return point->is_pressed;
 }
 
-void xpt2046_calibrate(uint16_t raw_x, uint16_t raw_y, 
+void xpt2046_calibrate(uint16_t raw_x, uint16_t raw_y,
                        uint16_t *screen_x, uint16_t *screen_y) {
     if (!screen_x || !screen_y) return;
     
@@ -157,64 +440,9 @@ void xpt2046_calibrate(uint16_t raw_x, uint16_t raw_y,
 }
 
 touch_gesture_t xpt2046_detect_gesture(void) {
-    touch_point_t point;
-    bool currently_touched = xpt2046_read(&point);
-    
-    // Touch started
-    if (currently_touched && !_gesture_state.is_touching) {
-        _gesture_state.is_touching = true;
-        _gesture_state.start_x = point.x;
-        _gesture_state.start_y = point.y;
-        _gesture_state.last_x = point.x;
-        _gesture_state.last_y = point.y;
-        _gesture_state.touch_start_time = get_absolute_time();
-        return GESTURE_NONE;
-    }
-    
-    // Touch continuing
-    if (currently_touched && _gesture_state.is_touching) {
-        _gesture_state.last_x = point.x;
-        _gesture_state.last_y = point.y;
-        return GESTURE_NONE;
-    }
-    
-    // Touch ended
-    if (!currently_touched && _gesture_state.is_touching) {
-        _gesture_state.is_touching = false;
-        _gesture_state.touch_end_time = get_absolute_time();
-        
-        // Calculate touch duration
-        int64_t duration_ms = absolute_time_diff_us(_gesture_state.touch_start_time, 
-                                                     _gesture_state.touch_end_time) / 1000;
-        
-        // Calculate movement
-        int32_t dx = (int32_t)_gesture_state.last_x - (int32_t)_gesture_state.start_x;
-        int32_t dy = (int32_t)_gesture_state.last_y - (int32_t)_gesture_state.start_y;
-        int32_t distance = dx * dx + dy * dy;  // Squared distance
-        
-        // Long press detection
-        if (duration_ms > TOUCH_HOLD_TIME_MS && distance < (SWIPE_THRESHOLD_PX * SWIPE_THRESHOLD_PX)) {
-            return GESTURE_LONG_PRESS;
-        }
-        
-        // Tap detection
-        if (duration_ms < SWIPE_TIMEOUT_MS && distance < (SWIPE_THRESHOLD_PX * SWIPE_THRESHOLD_PX)) {
-            return GESTURE_TAP;
-        }
-        
-        // Swipe detection
-        if (duration_ms < SWIPE_TIMEOUT_MS && distance >= (SWIPE_THRESHOLD_PX * SWIPE_THRESHOLD_PX)) {
-            // Determine swipe direction
-            if (abs(dx) > abs(dy)) {
-                // Horizontal swipe
-                return (dx > 0) ? GESTURE_SWIPE_RIGHT : GESTURE_SWIPE_LEFT;
-            } else {
-                // Vertical swipe
-                return (dy > 0) ? GESTURE_SWIPE_DOWN : GESTURE_SWIPE_UP;
-            }
-        }
+    touch_gesture_t gesture;
+    if (queue_try_remove(&_gesture_queue, &gesture)) {
+        return gesture;
     }
-    
     return GESTURE_NONE;
 }
-
@@ -0,0 +1,77 @@
+/**
+ * @file band_buffer.c
+ * @brief Latest-wins triple buffer implementation
+ * 
+ * Three frames rotate between three roles: the producer's write slot, the
+ * shared "ready" slot and the consumer's read slot. Publishing swaps the
+ * write and ready slots, acquiring swaps the ready and read slots. Only the
+ * index swap is guarded (by an RP2040 hardware spinlock, a handful of
+ * cycles); frame contents are never touched by both cores at once.
+ */
+
+#include "utils/band_buffer.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+_Static_assert(FFT_RESULT_BUFFER == 3, "band_buffer is a triple buffer");
+
+// ============================================================================
+// Private State
+// ============================================================================
+
+static band_frame_t _frames[FFT_RESULT_BUFFER];
+static uint8_t _write_index = 0;   // Owned by producer
+static uint8_t _ready_index = 1;   // Shared, guarded by _lock
+static uint8_t _read_index = 2;    // Owned by consumer
+static bool _ready_is_new = false; // Shared, guarded by _lock
+static uint32_t _sequence = 0;     // Owned by producer
+static spin_lock_t *_lock = NULL;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void band_buffer_init(void) {
+    memset(_frames, 0, sizeof(_frames));
+    _write_index = 0;
+    _ready_index = 1;
+    _read_index = 2;
+    _ready_is_new = false;
+    _sequence = 0;
+    
+    if (!_lock) {
+        _lock = spin_lock_init(spin_lock_claim_unused(true));
+    }
+}
+
+band_frame_t *band_buffer_begin_write(void) {
+    return &_frames[_write_index];
+}
+
+void band_buffer_publish(void) {
+    _frames[_write_index].sequence = ++_sequence;
+    
+    // Spinlock acquire/release include the memory barriers
+    uint32_t irq = spin_lock_blocking(_lock);
+    uint8_t ready = _ready_index;
+    _ready_index = _write_index;
+    _ready_is_new = true;
+    spin_unlock(_lock, irq);
+    
+    // Whatever was in the ready slot is stale now; overwrite it next time
+    _write_index = ready;
+}
+
+const band_frame_t *band_buffer_acquire(void) {
+    uint32_t irq = spin_lock_blocking(_lock);
+    bool is_new = _ready_is_new;
+    if (is_new) {
+        uint8_t ready = _ready_index;
+        _ready_index = _read_index;
+        _read_index = ready;
+        _ready_is_new = false;
+    }
+    spin_unlock(_lock, irq);
+    
+    return is_new ? &_frames[_read_index] : NULL;
+}
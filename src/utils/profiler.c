@@ -0,0 +1,222 @@
+/**
+ * @file profiler.c
+ * @brief Per-stage cycle profiling implementation
+ * 
+ * Histograms use four buckets per power of two (about 19% wide), so p50
+ * and p99 are reported as the upper edge of the bucket they fall in,
+ * capped at the exact maximum.
+ */
+
+#include "utils/profiler.h"
+
+#if PROFILE_ENABLE
+
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define NUM_CORES       2
+#define HIST_MIN_LOG2   6       // Bucket 0 holds everything below 64 cycles
+#define HIST_MAX_LOG2   23      // SysTick is 24 bits
+#define HIST_BUCKETS    (1 + (HIST_MAX_LOG2 - HIST_MIN_LOG2 + 1) * 4)
+
+typedef struct {
+    uint16_t buckets[HIST_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+    uint64_t total;
+} histogram_t;
+
+static const char *_stage_names[PROF_STAGE_COUNT] = {
+    "adc", "fft", "bands", "dynamics", "touch", "render", "transfer", "frame"
+};
+
+static const char *_counter_names[PROF_COUNTER_COUNT] = {
+    "adc overruns", "fft failures", "frames skipped", "frames dropped"
+};
+
+// ============================================================================
+// Private State
+// ============================================================================
+
+static histogram_t _stages[NUM_CORES][PROF_STAGE_COUNT];
+static histogram_t _themes[PROFILER_MAX_THEMES];
+static const char *_theme_names[PROFILER_MAX_THEMES];
+static volatile uint32_t _counters[PROF_COUNTER_COUNT];
+static uint32_t _cycles_per_us = 1;
+
+// ============================================================================
+// Histograms
+// ============================================================================
+
+static uint8_t bucket_index(uint32_t cycles) {
+    if (cycles < (1u << HIST_MIN_LOG2)) return 0;
+    
+    uint8_t log2 = (uint8_t)(31 - __builtin_clz(cycles));
+    if (log2 > HIST_MAX_LOG2) return HIST_BUCKETS - 1;
+    
+    uint8_t sub = (uint8_t)((cycles >> (log2 - 2)) & 3);
+    return (uint8_t)(1 + (log2 - HIST_MIN_LOG2) * 4 + sub);
+}
+
+static uint32_t bucket_upper(uint8_t index) {
+    if (index == 0) return 1u << HIST_MIN_LOG2;
+    
+    uint8_t log2 = (uint8_t)((index - 1) / 4 + HIST_MIN_LOG2);
+    uint8_t sub = (uint8_t)((index - 1) % 4);
+    return (uint32_t)(5 + sub) << (log2 - 2);
+}
+
+static void histogram_add(histogram_t *h, uint32_t cycles) {
+    uint8_t index = bucket_index(cycles);
+    
+    // Keep the shape (and the percentiles) when a bucket fills up
+    if (h->buckets[index] == UINT16_MAX) {
+        for (uint8_t i = 0; i < HIST_BUCKETS; i++) {
+            h->buckets[i] >>= 1;
+        }
+    }
+    h->buckets[index]++;
+    
+    h->count++;
+    h->total += cycles;
+    if (cycles > h->max) h->max = cycles;
+}
+
+/**
+ * @brief Cycles below which the given share (per mille) of samples fall
+ */
+static uint32_t histogram_percentile(const histogram_t *h, uint32_t per_mille) {
+    uint32_t in_buckets = 0;
+    for (uint8_t i = 0; i < HIST_BUCKETS; i++) {
+        in_buckets += h->buckets[i];
+    }
+    if (in_buckets == 0) return 0;
+    
+    uint32_t target = (in_buckets * per_mille + 999) / 1000;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= target) {
+            uint32_t upper = bucket_upper(i);
+            return (upper < h->max) ? upper : h->max;
+        }
+    }
+    
+    return h->max;
+}
+
+static void print_histogram(const char *label, const histogram_t *h) {
+    if (h->count == 0) return;
+    
+    uint32_t p50 = histogram_percentile(h, 500);
+    uint32_t p99 = histogram_percentile(h, 990);
+    uint32_t avg = (uint32_t)(h->total / h->count);
+    
+    printf("  %-16s %8lu %9lu %9lu %9lu %9lu | %7lu us p99, %7lu us max\n",
+           label, h->count, avg, p50, p99, h->max,
+           p99 / _cycles_per_us, h->max / _cycles_per_us);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void profiler_init(void) {
+    memset(_stages, 0, sizeof(_stages));
+    memset(_themes, 0, sizeof(_themes));
+    memset(_theme_names, 0, sizeof(_theme_names));
+    for (uint8_t i = 0; i < PROF_COUNTER_COUNT; i++) {
+        _counters[i] = 0;
+    }
+    
+    _cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+    if (_cycles_per_us == 0) _cycles_per_us = 1;
+    
+    profiler_start_core();
+    
+    DEBUG_PRINTF("Profiler initialized (%lu cycles/us, 'p' dumps, 'r' resets)\n", _cycles_per_us);
+}
+
+void profiler_start_core(void) {
+    // Free-running 24-bit down counter on the processor clock, no interrupt
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;  // ENABLE | CLKSOURCE
+}
+
+void profiler_record(prof_stage_t stage, uint32_t cycles) {
+    if (stage >= PROF_STAGE_COUNT) return;
+    histogram_add(&_stages[get_core_num()][stage], cycles);
+}
+
+void profiler_record_theme(uint8_t theme, uint32_t cycles) {
+    if (theme >= PROFILER_MAX_THEMES) return;
+    histogram_add(&_themes[theme], cycles);
+}
+
+void profiler_name_theme(uint8_t theme, const char *name) {
+    if (theme >= PROFILER_MAX_THEMES) return;
+    _theme_names[theme] = name;
+}
+
+void profiler_set_counter(prof_counter_t counter, uint32_t value) {
+    if (counter >= PROF_COUNTER_COUNT) return;
+    _counters[counter] = value;
+}
+
+void profiler_add_counter(prof_counter_t counter, uint32_t delta) {
+    if (counter >= PROF_COUNTER_COUNT) return;
+    _counters[counter] += delta;
+}
+
+void profiler_dump(void) {
+    printf("\n=== Profile (cycles, %lu per us) ===\n", _cycles_per_us);
+    printf("  %-16s %8s %9s %9s %9s %9s\n", "stage", "count", "avg", "p50", "p99", "max");
+    
+    char label[24];
+    for (uint8_t core = 0; core < NUM_CORES; core++) {
+        for (uint8_t s = 0; s < PROF_STAGE_COUNT; s++) {
+            snprintf(label, sizeof(label), "core%u %s", core, _stage_names[s]);
+            print_histogram(label, &_stages[core][s]);
+        }
+    }
+    
+    for (uint8_t t = 0; t < PROFILER_MAX_THEMES; t++) {
+        if (_theme_names[t]) {
+            snprintf(label, sizeof(label), "theme %.10s", _theme_names[t]);
+        } else {
+            snprintf(label, sizeof(label), "theme %u", t);
+        }
+        print_histogram(label, &_themes[t]);
+    }
+    
+    for (uint8_t c = 0; c < PROF_COUNTER_COUNT; c++) {
+        printf("  %-16s %8lu\n", _counter_names[c], _counters[c]);
+    }
+    printf("\n");
+}
+
+void profiler_reset(void) {
+    memset(_stages, 0, sizeof(_stages));
+    memset(_themes, 0, sizeof(_themes));
+    printf("Profile reset\n");
+}
+
+bool profiler_handle_command(int c) {
+    if (c == 'p') {
+        profiler_dump();
+    } else if (c == 'r') {
+        profiler_reset();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#endif // PROFILE_ENABLE
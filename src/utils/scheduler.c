@@ -0,0 +1,159 @@
+/**
+ * @file scheduler.c
+ * @brief Cooperative per-core task scheduler implementation
+ * 
+ * Periodic tasks are due at next_due_us and keep a fixed grid: after a run
+ * the next period starts one period later, not one period after the run.
+ * Lateness of a whole period or more realigns the grid to the current time
+ * and drops the missed periods, so a slow frame costs frames instead of a
+ * burst of back-to-back renders that would delay every other task.
+ * 
+ * Idle waiting uses WFE with a timeout: any interrupt (DMA block, touch
+ * scan, timer) wakes the core early for event tasks.
+ */
+
+#include "utils/scheduler.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// Private Functions
+// ============================================================================
+
+static sched_task_t *add_task(scheduler_t *sched, const char *name, sched_run_fn run) {
+    if (!sched || !run || sched->num_tasks >= SCHEDULER_MAX_TASKS) return NULL;
+    
+    sched_task_t *task = &sched->tasks[sched->num_tasks++];
+    memset(task, 0, sizeof(*task));
+    task->name = name;
+    task->run = run;
+    return task;
+}
+
+/**
+ * @brief Check whether a task should run now, dropping missed periods
+ */
+static bool task_is_due(sched_task_t *task, uint64_t now) {
+    if (task->ready) return task->ready();
+    if (now < task->next_due_us) return false;
+    
+    uint64_t late = now - task->next_due_us;
+    if (late >= task->period_us) {
+        uint32_t missed = (uint32_t)(late / task->period_us);
+        if (task->skippable) {
+            task->dropped += missed;
+        }
+        task->next_due_us += (uint64_t)missed * task->period_us;
+    }
+    return true;
+}
+
+static void run_task(sched_task_t *task, uint64_t now) {
+    bool did_work = task->run();
+    uint64_t end = time_us_64();
+    
+    if (!task->ready) {
+        task->next_due_us += task->period_us;
+    }
+    if (!did_work) return;
+    
+    uint32_t elapsed = (uint32_t)(end - now);
+    task->runs++;
+    task->busy_us += elapsed;
+    if (elapsed > task->max_us) task->max_us = elapsed;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void scheduler_init(scheduler_t *sched) {
+    memset(sched, 0, sizeof(*sched));
+    sched->stats_start_us = time_us_64();
+}
+
+sched_task_t *scheduler_add_event(scheduler_t *sched, const char *name,
+                                  sched_run_fn run, sched_ready_fn ready) {
+    if (!ready) return NULL;
+    
+    sched_task_t *task = add_task(sched, name, run);
+    if (task) {
+        task->ready = ready;
+    }
+    return task;
+}
+
+sched_task_t *scheduler_add_periodic(scheduler_t *sched, const char *name,
+                                     sched_run_fn run, uint32_t period_us, bool skippable) {
+    if (period_us == 0) return NULL;
+    
+    sched_task_t *task = add_task(sched, name, run);
+    if (task) {
+        task->period_us = period_us;
+        task->skippable = skippable;
+        task->next_due_us = time_us_64();
+    }
+    return task;
+}
+
+void scheduler_run_once(scheduler_t *sched) {
+    uint64_t now = time_us_64();
+    uint64_t next_due = UINT64_MAX;
+    
+    // Highest priority first; run one task and rescan from the top
+    for (uint8_t i = 0; i < sched->num_tasks; i++) {
+        sched_task_t *task = &sched->tasks[i];
+        if (task_is_due(task, now)) {
+            run_task(task, now);
+            return;
+        }
+        if (!task->ready && task->next_due_us < next_due) {
+            next_due = task->next_due_us;
+        }
+    }
+    
+    // Nothing to do: sleep until the next period or any interrupt
+    if (next_due == UINT64_MAX) {
+        __wfi();
+    } else {
+        best_effort_wfe_or_timeout(from_us_since_boot(next_due));
+    }
+    sched->idle_us += time_us_64() - now;
+}
+
+void scheduler_run(scheduler_t *sched) {
+    while (true) {
+        scheduler_run_once(sched);
+    }
+}
+
+void scheduler_reset_stats(scheduler_t *sched) {
+    for (uint8_t i = 0; i < sched->num_tasks; i++) {
+        sched_task_t *task = &sched->tasks[i];
+        task->runs = 0;
+        task->dropped = 0;
+        task->max_us = 0;
+        task->busy_us = 0;
+    }
+    sched->idle_us = 0;
+    sched->stats_start_us = time_us_64();
+}
+
+void scheduler_print_stats(const scheduler_t *sched) {
+    float interval_us = (float)(time_us_64() - sched->stats_start_us);
+    if (interval_us <= 0.0f) return;
+    
+    for (uint8_t i = 0; i < sched->num_tasks; i++) {
+        const sched_task_t *task = &sched->tasks[i];
+        printf("  %-8s %6.1f/s  max %6.2f ms  load %4.1f%%",
+               task->name, task->runs * 1e6f / interval_us, task->max_us / 1000.0f,
+               100.0f * task->busy_us / interval_us);
+        if (task->skippable) {
+            printf("  dropped %lu", task->dropped);
+        }
+        printf("\n");
+    }
+    printf("  %-8s %27s %4.1f%%\n", "idle", "", 100.0f * sched->idle_us / interval_us);
+}
@@ -0,0 +1,247 @@
+/**
+ * @file spectrum_stream.c
+ * @brief Binary spectrum streaming implementation
+ * 
+ * The producer (audio core) assembles packets in private staging buffers
+ * and commits each one whole into a byte SPSC ring, or drops it whole if
+ * the ring is full; the ring therefore only ever holds complete packets.
+ * The consumer (display core) writes from the ring straight to the CDC
+ * driver, bypassing the stdio layer so there is no CR/LF translation and
+ * no UART copy of the binary data.
+ */
+
+#include "utils/spectrum_stream.h"
+#include "utils/spsc_ring.h"
+#include "config.h"
+
+#if LIB_PICO_STDIO_USB
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+#endif
+
+#define BAND_PACKET_BYTES \
+    STREAM_PACKET_BYTES(STREAM_BATCH_FRAMES * STREAM_BAND_RECORD_BYTES(BAND_COUNT_MAX, 2))
+#define BINS_PACKET_BYTES STREAM_PACKET_BYTES(4 + 4 + 2 + (FFT_SIZE_MAX / 2) * 2)
+
+_Static_assert((STREAM_BUFFER_BYTES & (STREAM_BUFFER_BYTES - 1)) == 0,
+               "STREAM_BUFFER_BYTES must be a power of 2");
+_Static_assert(STREAM_BUFFER_BYTES >= 2 * BINS_PACKET_BYTES,
+               "STREAM_BUFFER_BYTES must hold two magnitude packets");
+_Static_assert(STREAM_BATCH_FRAMES >= 1 && STREAM_BATCH_FRAMES <= 255,
+               "STREAM_BATCH_FRAMES must fit the record count");
+
+// ============================================================================
+// Private State
+// ============================================================================
+
+static volatile stream_mode_t _mode = STREAM_OFF;   // Written by either core
+
+// Staging ring, whole packets only
+static uint8_t _ring_storage[STREAM_BUFFER_BYTES];
+static spsc_ring_t _ring;
+
+// Producer state (audio core)
+static uint8_t _band_packet[BAND_PACKET_BYTES];
+static uint8_t _bins_packet[BINS_PACKET_BYTES];
+static uint8_t _batch_type = 0;         // Packet type of the open batch
+static uint8_t _batch_records = 0;
+static uint32_t _batch_bytes = 0;       // Payload bytes in the open batch
+static uint16_t _sequence = 0;
+static volatile uint32_t _dropped = 0;
+
+// CRC of every byte value, built by spectrum_stream_init() (RAM, no XIP misses)
+static uint16_t _crc_table[256];
+
+// ============================================================================
+// Private Functions
+// ============================================================================
+
+static inline uint8_t *put_u16(uint8_t *p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    return p + 2;
+}
+
+static inline uint8_t *put_u32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+    return p + 4;
+}
+
+/**
+ * @brief Fill _crc_table: CRC-16/CCITT-FALSE of each byte value, bitwise
+ */
+static void build_crc_table(void) {
+    for (uint32_t byte = 0; byte < 256; byte++) {
+        uint16_t crc = (uint16_t)(byte << 8);
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+        _crc_table[byte] = crc;
+    }
+}
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), one table lookup per byte
+ * 
+ * About 10 cycles per byte on the M0+ (the bitwise loop took ~50). A
+ * 1034-byte magnitude packet at FFT 1024 costs ~10k cycles.
+ */
+static uint16_t crc16(const uint8_t *data, uint32_t length) {
+    uint16_t crc = 0xFFFF;
+    for (uint32_t i = 0; i < length; i++) {
+        crc = (uint16_t)(crc << 8) ^ _crc_table[(crc >> 8) ^ data[i]];
+    }
+    return crc;
+}
+
+/**
+ * @brief Seal the packet, then stage it whole or drop it
+ */
+static void finish_packet(uint8_t *packet, uint8_t type, uint8_t records, uint32_t payload_bytes) {
+    uint32_t length = spectrum_stream_seal_packet(packet, (stream_packet_type_t)type, records,
+                                                  _sequence++, payload_bytes);
+    if (spsc_ring_free(&_ring) < length) {
+        _dropped++;
+        return;
+    }
+    spsc_ring_push(&_ring, packet, length);
+}
+
+static uint8_t band_packet_type(stream_mode_t mode) {
+    return (mode == STREAM_BANDS8) ? STREAM_PACKET_BANDS8 : STREAM_PACKET_BANDS16;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void spectrum_stream_init(void) {
+    build_crc_table();
+    spsc_ring_init(&_ring, _ring_storage, 1, STREAM_BUFFER_BYTES);
+    _batch_type = 0;
+    _batch_records = 0;
+    _batch_bytes = 0;
+    _sequence = 0;
+    _dropped = 0;
+    _mode = (STREAM_BOOT_MODE < STREAM_MODE_COUNT) ? (stream_mode_t)STREAM_BOOT_MODE : STREAM_OFF;
+}
+
+void spectrum_stream_set_mode(stream_mode_t mode) {
+    if (mode >= STREAM_MODE_COUNT) return;
+    _mode = mode;
+}
+
+stream_mode_t spectrum_stream_get_mode(void) {
+    return _mode;
+}
+
+void spectrum_stream_push_bands(const float *bands, uint8_t num_bands, uint32_t timestamp_us) {
+    stream_mode_t mode = _mode;
+    if (mode == STREAM_OFF || !bands || num_bands == 0 || num_bands > BAND_COUNT_MAX) return;
+    
+    // A mode change abandons the open batch (mixed formats can't share it)
+    uint8_t type = band_packet_type(mode);
+    if (type != _batch_type) {
+        _batch_type = type;
+        _batch_records = 0;
+        _batch_bytes = 0;
+    }
+    
+    _batch_bytes += spectrum_stream_encode_bands(&_band_packet[STREAM_HEADER_BYTES + _batch_bytes],
+                                                 (stream_packet_type_t)type, bands, num_bands,
+                                                 timestamp_us);
+    
+    if (++_batch_records >= STREAM_BATCH_FRAMES) {
+        finish_packet(_band_packet, type, _batch_records, _batch_bytes);
+        _batch_records = 0;
+        _batch_bytes = 0;
+    }
+}
+
+void spectrum_stream_push_bins(const uint16_t *bins, uint16_t num_bins,
+                               uint32_t sample_rate_hz, uint32_t timestamp_us) {
+    if (_mode != STREAM_BANDS_BINS || !bins || num_bins == 0) return;
+    if (num_bins > FFT_SIZE_MAX / 2) num_bins = FFT_SIZE_MAX / 2;
+    
+    uint8_t *p = &_bins_packet[STREAM_HEADER_BYTES];
+    p = put_u32(p, timestamp_us);
+    p = put_u32(p, sample_rate_hz);
+    p = put_u16(p, num_bins);
+    for (uint16_t k = 0; k < num_bins; k++) {
+        p = put_u16(p, bins[k]);
+    }
+    
+    finish_packet(_bins_packet, STREAM_PACKET_BINS16, 1,
+                  (uint32_t)(p - &_bins_packet[STREAM_HEADER_BYTES]));
+}
+
+bool spectrum_stream_service(void) {
+    uint32_t pending = spsc_ring_available(&_ring);
+    if (pending == 0) return false;
+
+#if LIB_PICO_STDIO_USB
+    if (!stdio_usb_connected()) {
+        spsc_ring_release(&_ring, pending);
+        return true;
+    }
+    
+    // At most two pieces: up to the end of the ring, then from the start
+    bool wrote = false;
+    for (uint8_t piece = 0; piece < 2 && pending > 0; piece++) {
+        uint32_t room = tud_cdc_write_available();
+        uint32_t contiguous = STREAM_BUFFER_BYTES - spsc_ring_index(&_ring, _ring.tail);
+        uint32_t n = pending;
+        if (n > contiguous) n = contiguous;
+        if (n > room) n = room;
+        if (n == 0) break;
+        
+        stdio_usb.out_chars((const char *)spsc_ring_read_ptr(&_ring), (int)n);
+        spsc_ring_release(&_ring, n);
+        pending -= n;
+        wrote = true;
+    }
+    return wrote;
+#else
+    // No USB CDC in this build: nowhere to send
+    spsc_ring_release(&_ring, pending);
+    return true;
+#endif
+}
+
+uint32_t spectrum_stream_dropped(void) {
+    return _dropped;
+}
+
+uint32_t spectrum_stream_encode_bands(uint8_t *dst, stream_packet_type_t type, const float *bands,
+                                      uint8_t num_bands, uint32_t timestamp_us) {
+    uint8_t *p = put_u32(dst, timestamp_us);
+    *p++ = num_bands;
+    for (uint8_t i = 0; i < num_bands; i++) {
+        float level = bands[i];
+        if (level < 0.0f) level = 0.0f;
+        if (level > 1.0f) level = 1.0f;
+        if (type == STREAM_PACKET_BANDS8) {
+            *p++ = (uint8_t)(level * 255.0f + 0.5f);
+        } else {
+            p = put_u16(p, (uint16_t)(level * 65535.0f + 0.5f));
+        }
+    }
+    return (uint32_t)(p - dst);
+}
+
+uint32_t spectrum_stream_seal_packet(uint8_t *packet, stream_packet_type_t type, uint8_t records,
+                                     uint16_t sequence, uint32_t payload_bytes) {
+    packet[0] = STREAM_SYNC0;
+    packet[1] = STREAM_SYNC1;
+    packet[2] = (uint8_t)type;
+    packet[3] = records;
+    put_u16(&packet[4], sequence);
+    put_u16(&packet[6], (uint16_t)payload_bytes);
+    
+    uint32_t length = STREAM_HEADER_BYTES + payload_bytes;
+    put_u16(&packet[length], crc16(&packet[2], length - 2));
+    return length + STREAM_CRC_BYTES;
+}
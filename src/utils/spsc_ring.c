@@ -0,0 +1,84 @@
+/**
+ * @file spsc_ring.c
+ * @brief Lock-free single-producer/single-consumer ring implementation
+ * 
+ * Bulk operations copy in at most two pieces (up to the end of the ring,
+ * then from the start). Each side reads the other side's index once per
+ * call, so a concurrent update only means fewer elements this time.
+ */
+
+#include "utils/spsc_ring.h"
+#include <string.h>
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool spsc_ring_init(spsc_ring_t *ring, void *buffer, uint32_t element_size, uint32_t capacity) {
+    if (!ring || !buffer || element_size == 0) return false;
+    if (capacity == 0 || (capacity & (capacity - 1))) return false;
+    
+    ring->buffer = (uint8_t *)buffer;
+    ring->element_size = element_size;
+    ring->capacity = capacity;
+    ring->mask = capacity - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overruns = 0;
+    return true;
+}
+
+void spsc_ring_reset(spsc_ring_t *ring) {
+    ring->head = 0;
+    ring->tail = 0;
+    __dmb();
+}
+
+uint32_t spsc_ring_push(spsc_ring_t *ring, const void *items, uint32_t count) {
+    if (!items || count == 0) return 0;
+    
+    uint32_t head = ring->head;
+    uint32_t space = ring->capacity - (head - ring->tail);
+    uint32_t n = (count < space) ? count : space;
+    
+    // Consumer may still be reading the free slots until its tail update
+    // is visible; the barrier orders our stores after that load
+    __dmb();
+    
+    uint32_t pos = head & ring->mask;
+    uint32_t first = ring->capacity - pos;
+    if (first > n) first = n;
+    
+    const uint8_t *src = (const uint8_t *)items;
+    memcpy(ring->buffer + pos * ring->element_size, src, first * ring->element_size);
+    memcpy(ring->buffer, src + first * ring->element_size, (n - first) * ring->element_size);
+    
+    spsc_ring_commit(ring, n);
+    
+    if (n < count) {
+        ring->overruns += count - n;
+    }
+    return n;
+}
+
+uint32_t spsc_ring_pop(spsc_ring_t *ring, void *items, uint32_t count) {
+    if (!items || count == 0) return 0;
+    
+    uint32_t tail = ring->tail;
+    uint32_t ready = ring->head - tail;
+    uint32_t n = (count < ready) ? count : ready;
+    if (n == 0) return 0;
+    
+    __dmb();  // Element loads after the head load
+    
+    uint32_t pos = tail & ring->mask;
+    uint32_t first = ring->capacity - pos;
+    if (first > n) first = n;
+    
+    uint8_t *dst = (uint8_t *)items;
+    memcpy(dst, ring->buffer + pos * ring->element_size, first * ring->element_size);
+    memcpy(dst + first * ring->element_size, ring->buffer, (n - first) * ring->element_size);
+    
+    spsc_ring_release(ring, n);
+    return n;
+}